@@ -0,0 +1,216 @@
+#include <JuceHeader.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#if JUCE_LINUX || JUCE_MAC
+    #include <unistd.h>
+#endif
+
+#if JUCE_MAC
+    #include <mach/mach.h>
+#endif
+
+// Load-time benchmark for the built plug-in, the way a render node scanning and
+// instantiating plug-ins sees it. Nothing of the plug-in is linked in here, so
+// its static initialisers only run when the binary is opened and the tool works
+// unchanged against a build of any revision -- build the VST3 of the two trees
+// and run it on each for a before/after.
+//
+// Reports, with no editor ever created:
+//   - dlopen of the binary inside the bundle (static initialisers included) and
+//     the resident memory it added
+//   - the VST3 scan, i.e. reading the plug-in's description from its factory
+//   - creating --instances instances through the factory, which is where the
+//     wrapper calls createPluginFilter(), first one separately, and the
+//     resident memory per instance
+//   - prepareToPlay per instance and the resident memory after it
+//
+// Run it in a fresh process each time, a second dlopen in the same process
+// costs nothing.
+//
+// usage: PluginLoad <path to Delay.vst3> [--instances=100] [--sample-rate=48000] [--block=256]
+
+// ======= system counters =======
+// resident set size in bytes, 0 where it can't be read
+static size_t getResidentMemory() {
+   #if JUCE_LINUX
+    long pages = 0, resident = 0;
+    if (FILE* file = std::fopen("/proc/self/statm", "r")) {
+        if (std::fscanf(file, "%ld %ld", &pages, &resident) != 2)
+            resident = 0;
+        std::fclose(file);
+    }
+    return size_t(resident) * size_t(sysconf(_SC_PAGESIZE));
+   #elif JUCE_MAC
+    mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t) &info, &count) != KERN_SUCCESS)
+        return 0;
+    return size_t(info.resident_size);
+   #else
+    return 0;
+   #endif
+}
+
+// the shared library inside a VST3 bundle, e.g. Contents/x86_64-linux/Delay.so
+static juce::File findBinary(const juce::File& bundle) {
+    if (bundle.existsAsFile())
+        return bundle; // Windows single-file VST3 or the binary itself
+
+   #if JUCE_LINUX
+    const char* pattern = "*.so";
+   #elif JUCE_MAC
+    const char* pattern = "*";
+    if (auto macOS = bundle.getChildFile("Contents/MacOS"); macOS.isDirectory())
+        return macOS.getChildFile(bundle.getFileNameWithoutExtension());
+   #else
+    const char* pattern = "*.vst3";
+   #endif
+
+    auto files = bundle.getChildFile("Contents").findChildFiles(juce::File::findFiles, true, pattern);
+    return files.isEmpty() ? juce::File() : files.getFirst();
+}
+
+// ======= reporting =======
+static double since(double start) {
+    return juce::Time::getMillisecondCounterHiRes() - start;
+}
+
+static void printMemory(const char* what, size_t before, size_t after, int count) {
+    if (before == 0 || after == 0) {
+        std::printf("%-22s n/a\n", what);
+        return;
+    }
+
+    double added = double(after) - double(before);
+    std::printf("%-22s %8.1f MB total   %8.1f kB added", what, double(after) / 1048576.0, added / 1024.0);
+    if (count > 1)
+        std::printf(", %8.1f kB per instance", added / double(count) / 1024.0);
+    std::printf("\n");
+}
+
+static void printTimes(const char* what, const std::vector<double>& times) {
+    double sum = 0.0, max = 0.0;
+    for (double time : times) {
+        sum += time;
+        max = std::max(max, time);
+    }
+    std::printf("%-22s mean %8.3f ms   max %8.3f ms\n", what, sum / double(times.size()), max);
+}
+
+int main(int argc, char* argv[]) {
+    // taken before anything else -- the plug-in's statics don't exist yet
+    size_t baseline = getResidentMemory();
+
+    juce::ScopedJuceInitialiser_GUI juceInitialiser; // VST3 instances are created on the message thread
+    juce::ArgumentList args(argc, argv);
+
+    if (args.size() == 0 || args[0].isOption()) {
+        std::printf("usage: PluginLoad <path to Delay.vst3> [--instances=100] [--sample-rate=48000] [--block=256]\n");
+        return 1;
+    }
+
+    auto option = [&](const char* name, double fallback) {
+        return args.containsOption(name) ? args.getValueForOption(name).getDoubleValue() : fallback;
+    };
+
+    juce::File bundle = args[0].resolveAsFile();
+    int numInstances = std::max(1, int(option("--instances", 100)));
+    double sampleRate = option("--sample-rate", 48000.0);
+    int blockSize = juce::jlimit(1, 8192, int(option("--block", 256)));
+
+    juce::File binary = findBinary(bundle);
+    if (!binary.existsAsFile()) {
+        std::printf("no plug-in binary in %s\n", bundle.getFullPathName().toRawUTF8());
+        return 1;
+    }
+
+    std::printf("PluginLoad -- %s, %d instances, %.0f Hz, %d samples\n\n",
+                binary.getFullPathName().toRawUTF8(), numInstances, sampleRate, blockSize);
+
+    size_t initialised = getResidentMemory();
+    printMemory("resident, JUCE only", baseline, initialised, 1);
+
+    // ======= dlopen =======
+    // stays open until the end, so the VST3 format below reuses the loaded image
+    // instead of paying for the static initialisers a second time
+    juce::DynamicLibrary library;
+    double start = juce::Time::getMillisecondCounterHiRes();
+    if (!library.open(binary.getFullPathName())) {
+        std::printf("dlopen failed\n");
+        return 1;
+    }
+    double openTime = since(start);
+    size_t opened = getResidentMemory();
+
+    std::printf("%-22s     %8.3f ms\n", "dlopen", openTime);
+    printMemory("resident, opened", initialised, opened, 1);
+
+    // ======= scan =======
+    juce::VST3PluginFormat format;
+    juce::OwnedArray<juce::PluginDescription> types;
+
+    start = juce::Time::getMillisecondCounterHiRes();
+    format.findAllTypesForFile(types, bundle.getFullPathName());
+    double scanTime = since(start);
+
+    if (types.isEmpty()) {
+        std::printf("the VST3 factory didn't report any plug-in\n");
+        return 1;
+    }
+
+    std::printf("%-22s     %8.3f ms\n", "scan", scanTime);
+
+    // ======= instantiation =======
+    std::vector<std::unique_ptr<juce::AudioPluginInstance>> instances;
+    std::vector<double> createTimes;
+    juce::String error;
+
+    size_t beforeInstances = getResidentMemory();
+    for (int i = 0; i < numInstances; ++i) {
+        start = juce::Time::getMillisecondCounterHiRes();
+        auto instance = format.createInstanceFromDescription(*types.getFirst(), sampleRate, blockSize, error);
+        createTimes.push_back(since(start));
+
+        if (instance == nullptr) {
+            std::printf("creating instance %d failed -- %s\n", i, error.toRawUTF8());
+            return 1;
+        }
+        instances.push_back(std::move(instance));
+    }
+    size_t created = getResidentMemory();
+
+    std::printf("%-22s     %8.3f ms\n", "first instance", createTimes.front());
+    if (numInstances > 1)
+        printTimes("further instances", std::vector<double>(createTimes.begin() + 1, createTimes.end()));
+    printMemory("resident, created", beforeInstances, created, numInstances);
+
+    // ======= prepare =======
+    std::vector<double> prepareTimes;
+    for (auto& instance : instances) {
+        instance->setRateAndBufferSizeDetails(sampleRate, blockSize);
+
+        start = juce::Time::getMillisecondCounterHiRes();
+        instance->prepareToPlay(sampleRate, blockSize);
+        prepareTimes.push_back(since(start));
+    }
+
+    // the processors' timers pick the internal rate and the kernels up
+    juce::MessageManager::getInstance()->runDispatchLoopUntil(500);
+    size_t prepared = getResidentMemory();
+
+    printTimes("prepareToPlay", prepareTimes);
+    printMemory("resident, prepared", beforeInstances, prepared, numInstances);
+
+    for (auto& instance : instances)
+        instance->releaseResources();
+    instances.clear();
+
+    // what one scan and the first instance cost a host that had nothing of the plug-in loaded
+    std::printf("\n%-22s     %8.3f ms   %8.1f MB resident added\n", "load total",
+                openTime + scanTime + createTimes.front(), (double(created) - double(initialised)) / 1048576.0);
+    return 0;
+}
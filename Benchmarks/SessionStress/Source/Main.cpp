@@ -0,0 +1,470 @@
+#include <JuceHeader.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "../../../Source/PluginProcessor.h"
+
+#if JUCE_LINUX || JUCE_MAC
+    #include <sys/resource.h>
+    #include <unistd.h>
+#endif
+
+#if JUCE_LINUX
+    #include <linux/perf_event.h>
+    #include <sys/syscall.h>
+#endif
+
+#if JUCE_MAC
+    #include <mach/mach.h>
+#endif
+
+// Session-scale benchmark for DelayAudioProcessor, no editors are opened.
+//
+// Creates --instances processors the way a host loading a dense session would
+// and reports:
+//   - resident memory per instance after construction and after prepareToPlay,
+//     next to what getWetPathMemoryUsage() accounts for
+//   - prepareToPlay and setStateInformation time per instance
+//   - processing cost per block with every instance run one after the other on
+//     one thread, and spread over a pool of worker threads
+//   - page faults (getrusage) and cache misses (perf_event_open, Linux only)
+//     for each of those runs, where the system allows it
+//
+// The plug-in is linked in, so its static initialisers have run before main()
+// and the library load isn't part of any of this -- Benchmarks/PluginLoad
+// measures those on the built binary.
+//
+// --sweep runs the same instances once per host block size from 16 to 8192
+// instead and prints ns per sample for each, which should stay flat.
+//
+// usage: SessionStress [--instances=100] [--sample-rate=48000] [--block=256]
+//                      [--seconds=10] [--threads=<cpus>] [--internal-rate=0|1|2]
+//                      [--character=0-3] [--drive=<dB>] [--long] [--sweep]
+
+static constexpr int sweepBlockSizes[] = { 16, 32, 64, 128, 256, 512, 1024, 2048, 4096, 8192 };
+static constexpr int maxBlockSize = 8192;
+
+// ======= system counters =======
+// resident set size in bytes, 0 where it can't be read
+static size_t getResidentMemory() {
+   #if JUCE_LINUX
+    long pages = 0, resident = 0;
+    if (FILE* file = std::fopen("/proc/self/statm", "r")) {
+        if (std::fscanf(file, "%ld %ld", &pages, &resident) != 2)
+            resident = 0;
+        std::fclose(file);
+    }
+    return size_t(resident) * size_t(sysconf(_SC_PAGESIZE));
+   #elif JUCE_MAC
+    mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t) &info, &count) != KERN_SUCCESS)
+        return 0;
+    return size_t(info.resident_size);
+   #else
+    return 0;
+   #endif
+}
+
+struct PageFaults
+{
+    juce::int64 minor = -1;
+    juce::int64 major = -1;
+
+    static PageFaults now() {
+        PageFaults faults;
+       #if JUCE_LINUX || JUCE_MAC
+        rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) == 0) {
+            faults.minor = usage.ru_minflt;
+            faults.major = usage.ru_majflt;
+        }
+       #endif
+        return faults;
+    }
+};
+
+// hardware cache counters for this thread and every thread started while they're
+// open -- inherited counters only add up once those threads have exited
+class CacheCounters
+{
+public:
+    void start() {
+       #if JUCE_LINUX
+        misses = open(PERF_COUNT_HW_CACHE_MISSES);
+        references = open(PERF_COUNT_HW_CACHE_REFERENCES);
+       #endif
+    }
+
+    // false when the counters aren't available, e.g. perf_event_paranoid or a VM
+    bool stop(juce::uint64& numMisses, juce::uint64& numReferences) {
+        bool ok = read(misses, numMisses) && read(references, numReferences);
+        close(misses);
+        close(references);
+        return ok;
+    }
+
+private:
+   #if JUCE_LINUX
+    static int open(juce::uint64 config) {
+        perf_event_attr attr{};
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = config;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        return int(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+   #endif
+
+    static bool read(int fd, juce::uint64& value) {
+       #if JUCE_LINUX
+        return fd >= 0 && ::read(fd, &value, sizeof(value)) == ssize_t(sizeof(value));
+       #else
+        juce::ignoreUnused(fd, value);
+        return false;
+       #endif
+    }
+
+    static void close(int& fd) {
+       #if JUCE_LINUX
+        if (fd >= 0)
+            ::close(fd);
+       #endif
+        fd = -1;
+    }
+
+    int misses = -1;
+    int references = -1;
+};
+
+// ======= session =======
+struct Settings
+{
+    int numInstances;
+    double sampleRate;
+    int blockSize;
+    double seconds;
+    int numThreads;
+    int internalRate;
+    int character;
+    float drive;
+    bool longMode;
+};
+
+class Session
+{
+public:
+    explicit Session(const Settings& s) : settings(s) {
+        juce::Random random(1);
+        input.setSize(2, maxBlockSize);
+        for (int ch = 0; ch < 2; ++ch)
+            for (int i = 0; i < input.getNumSamples(); ++i)
+                input.setSample(ch, i, (random.nextFloat() * 2.0f - 1.0f) * 0.25f);
+    }
+
+    std::vector<std::unique_ptr<DelayAudioProcessor>> processors;
+
+    void create() {
+        for (int i = 0; i < settings.numInstances; ++i) {
+            auto processor = std::make_unique<DelayAudioProcessor>();
+            set(*processor, rateParamID, float(settings.internalRate));
+            set(*processor, characterParamID, float(settings.character));
+            set(*processor, driveParamID, settings.drive);
+            set(*processor, longModeParamID, settings.longMode ? 1.0f : 0.0f);
+            set(*processor, feedbackParamID, 50.0f);
+            processors.push_back(std::move(processor));
+        }
+    }
+
+    // every instance at the given block size, returns the time each prepareToPlay took in ms
+    std::vector<double> prepare(int blockSize) {
+        std::vector<double> times;
+        buffers.clear();
+
+        for (auto& processor : processors) {
+            processor->releaseResources();
+            processor->setRateAndBufferSizeDetails(settings.sampleRate, blockSize);
+
+            double start = juce::Time::getMillisecondCounterHiRes();
+            processor->prepareToPlay(settings.sampleRate, blockSize);
+            times.push_back(juce::Time::getMillisecondCounterHiRes() - start);
+
+            buffers.emplace_back(2, blockSize);
+        }
+
+        currentBlockSize = blockSize;
+
+        // the processors' timers pick the internal rate, the long delay line and the kernels up
+        juce::MessageManager::getInstance()->runDispatchLoopUntil(500);
+        return times;
+    }
+
+    // one host block for one instance, fresh input every time so nothing builds up
+    void process(int index) {
+        auto& buffer = buffers[size_t(index)];
+        for (int ch = 0; ch < 2; ++ch)
+            buffer.copyFrom(ch, 0, input, ch, 0, currentBlockSize);
+
+        juce::MidiBuffer midi;
+        processors[size_t(index)]->processBlock(buffer, midi);
+    }
+
+    // the whole session one instance after the other, like a host running a chain on one thread
+    void processAll() {
+        for (int i = 0; i < int(processors.size()); ++i)
+            process(i);
+    }
+
+    int getNumBlocks() const noexcept {
+        return std::max(1, int(settings.seconds * settings.sampleRate) / currentBlockSize);
+    }
+
+    const Settings& settings;
+
+private:
+    static void set(DelayAudioProcessor& processor, const juce::ParameterID& id, float value) {
+        auto* parameter = processor.apvts.getParameter(id.getParamID());
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    }
+
+    juce::AudioBuffer<float> input;
+    std::vector<juce::AudioBuffer<float>> buffers;
+    int currentBlockSize = 0;
+};
+
+// ======= worker pool =======
+// spins between blocks like an audio thread pool does, every block is handed out
+// instance by instance to whichever thread is free, the calling thread included
+class WorkerPool
+{
+public:
+    WorkerPool(Session& s, int numThreads) : session(s) {
+        for (int i = 1; i < numThreads; ++i)
+            workers.push_back(std::make_unique<Worker>(*this));
+        for (auto& worker : workers)
+            worker->startThread(juce::Thread::Priority::highest);
+    }
+
+    ~WorkerPool() {
+        for (auto& worker : workers)
+            worker->signalThreadShouldExit();
+        for (auto& worker : workers)
+            worker->stopThread(1000);
+    }
+
+    void processBlock() {
+        done.store(0, std::memory_order_relaxed);
+        next.store(0, std::memory_order_relaxed);
+        generation.fetch_add(1, std::memory_order_release);
+
+        runJobs();
+
+        while (done.load(std::memory_order_acquire) < numJobs())
+            juce::Thread::yield();
+    }
+
+private:
+    struct Worker : public juce::Thread
+    {
+        explicit Worker(WorkerPool& p) : juce::Thread("Worker"), pool(p) { }
+
+        void run() override {
+            int seen = pool.generation.load(std::memory_order_acquire);
+            while (!threadShouldExit()) {
+                int current = pool.generation.load(std::memory_order_acquire);
+                if (current == seen) {
+                    juce::Thread::yield();
+                    continue;
+                }
+
+                seen = current;
+                pool.runJobs();
+            }
+        }
+
+        WorkerPool& pool;
+    };
+
+    int numJobs() const noexcept { return int(session.processors.size()); }
+
+    void runJobs() {
+        for (int i = next.fetch_add(1); i < numJobs(); i = next.fetch_add(1)) {
+            session.process(i);
+            done.fetch_add(1, std::memory_order_release);
+        }
+    }
+
+    Session& session;
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    std::atomic<int> generation{ 0 };
+    std::atomic<int> next{ 0 };
+    std::atomic<int> done{ 0 };
+};
+
+// ======= reporting =======
+static void printTimes(const char* what, const std::vector<double>& times) {
+    double sum = 0.0, max = 0.0;
+    for (double time : times) {
+        sum += time;
+        max = std::max(max, time);
+    }
+    std::printf("%-22s mean %8.3f ms   max %8.3f ms\n", what, sum / double(times.size()), max);
+}
+
+static void printMemory(const char* what, size_t before, size_t after, int numInstances) {
+    if (before == 0 || after == 0) {
+        std::printf("%-22s n/a\n", what);
+        return;
+    }
+
+    double perInstance = (double(after) - double(before)) / double(numInstances);
+    std::printf("%-22s %8.1f MB total   %8.1f kB per instance\n", what, double(after) / 1048576.0, perInstance / 1024.0);
+}
+
+// processes --seconds of audio on numThreads threads and prints the cost per sample
+// and instance, the share of realtime it took and the counters
+static void measure(const char* what, Session& session, int numThreads) {
+    const auto& settings = session.settings;
+    int numBlocks = session.getNumBlocks();
+    int blockSize = settings.blockSize;
+
+    // warms the caches and the branch predictors up first
+    for (int block = 0; block < std::min(numBlocks, 50); ++block)
+        session.processAll();
+
+    CacheCounters counters;
+    counters.start();
+    auto faultsBefore = PageFaults::now();
+    double elapsed;
+
+    {
+        // started after the counters are opened so the workers inherit them,
+        // and stopped before they're read so their counts are added in
+        std::unique_ptr<WorkerPool> pool;
+        if (numThreads > 1)
+            pool = std::make_unique<WorkerPool>(session, numThreads);
+
+        double start = juce::Time::getMillisecondCounterHiRes();
+
+        for (int block = 0; block < numBlocks; ++block) {
+            if (pool != nullptr)
+                pool->processBlock();
+            else
+                session.processAll();
+        }
+
+        elapsed = (juce::Time::getMillisecondCounterHiRes() - start) * 0.001;
+    }
+
+    auto faultsAfter = PageFaults::now();
+
+    double numSamples = double(numBlocks) * double(blockSize) * double(session.processors.size());
+    double audioSeconds = double(numBlocks) * double(blockSize) / settings.sampleRate;
+
+    std::printf("%-22s %8.2f ns per sample   %8.1f us per block   %6.1f%% of realtime on %d thread%s\n",
+                what, elapsed * 1.0e9 / numSamples, elapsed * 1.0e6 / double(numBlocks),
+                elapsed / audioSeconds * 100.0, numThreads, numThreads == 1 ? "" : "s");
+
+    if (faultsBefore.minor >= 0)
+        std::printf("%-22s %lld minor, %lld major page faults\n", "",
+                    (long long) (faultsAfter.minor - faultsBefore.minor),
+                    (long long) (faultsAfter.major - faultsBefore.major));
+
+    juce::uint64 misses = 0, references = 0;
+    if (counters.stop(misses, references))
+        std::printf("%-22s %.3f cache misses per sample, %.1f%% of references\n", "",
+                    double(misses) / numSamples, references > 0 ? double(misses) / double(references) * 100.0 : 0.0);
+    else
+        std::printf("%-22s cache counters n/a\n", "");
+}
+
+int main(int argc, char* argv[]) {
+    juce::ScopedJuceInitialiser_GUI juceInitialiser; // the processors' timers need a message thread
+    juce::ArgumentList args(argc, argv);
+
+    auto option = [&](const char* name, double fallback) {
+        return args.containsOption(name) ? args.getValueForOption(name).getDoubleValue() : fallback;
+    };
+
+    Settings settings;
+    settings.numInstances = std::max(1, int(option("--instances", 100)));
+    settings.sampleRate = option("--sample-rate", 48000.0);
+    settings.blockSize = juce::jlimit(1, 8192, int(option("--block", 256)));
+    settings.seconds = option("--seconds", 10.0);
+    settings.numThreads = std::max(1, int(option("--threads", juce::SystemStats::getNumCpus())));
+    settings.internalRate = juce::jlimit(0, 2, int(option("--internal-rate", 0)));
+    settings.character = juce::jlimit(0, 3, int(option("--character", 0)));
+    settings.drive = float(option("--drive", 0.0));
+    settings.longMode = args.containsOption("--long");
+
+    std::printf("SessionStress -- %d instances, %.0f Hz, %d samples, internal rate %s, character %s, drive %.1f dB%s\n\n",
+                settings.numInstances, settings.sampleRate, settings.blockSize,
+                rateChoices[settings.internalRate], characterChoices[settings.character], settings.drive,
+                settings.longMode ? ", long mode" : "");
+
+    Session session(settings);
+
+    // ======= instantiation =======
+    size_t baseline = getResidentMemory();
+    double start = juce::Time::getMillisecondCounterHiRes();
+    session.create();
+    double createTime = juce::Time::getMillisecondCounterHiRes() - start;
+    size_t created = getResidentMemory();
+
+    std::printf("%-22s mean %8.3f ms\n", "construction", createTime / double(settings.numInstances));
+    printMemory("resident, created", baseline, created, settings.numInstances);
+
+    // ======= sweep =======
+    if (args.containsOption("--sweep")) {
+        std::printf("\n");
+        for (int blockSize : sweepBlockSizes) {
+            settings.blockSize = blockSize;
+            session.prepare(blockSize);
+
+            char what[32];
+            std::snprintf(what, sizeof(what), "block %d", blockSize);
+            measure(what, session, 1);
+        }
+        return 0;
+    }
+
+    // ======= prepare and state =======
+    printTimes("prepareToPlay", session.prepare(settings.blockSize));
+    size_t prepared = getResidentMemory();
+    printMemory("resident, prepared", baseline, prepared, settings.numInstances);
+
+    size_t accounted = 0;
+    for (auto& processor : session.processors)
+        accounted += processor->getWetPathMemoryUsage();
+    std::printf("%-22s %8.1f MB total   %8.1f kB per instance\n", "wet path buffers",
+                double(accounted) / 1048576.0, double(accounted) / double(settings.numInstances) / 1024.0);
+
+    juce::MemoryBlock state;
+    session.processors.front()->getStateInformation(state);
+
+    std::vector<double> stateTimes;
+    for (auto& processor : session.processors) {
+        double stateStart = juce::Time::getMillisecondCounterHiRes();
+        processor->setStateInformation(state.getData(), int(state.getSize()));
+        stateTimes.push_back(juce::Time::getMillisecondCounterHiRes() - stateStart);
+    }
+    printTimes("setStateInformation", stateTimes);
+    juce::MessageManager::getInstance()->runDispatchLoopUntil(200);
+
+    // ======= throughput =======
+    std::printf("\n");
+    measure("serial", session, 1);
+    measure("worker pool", session, settings.numThreads);
+
+    for (auto& processor : session.processors)
+        processor->releaseResources();
+
+    return 0;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <array>
+
+// One-shot actions from the editor, as opposed to parameters.
+struct DelayCommand
+{
+    enum Type { clear, freeze, unfreeze, tap };
+
+    Type type;
+    double time; // juce::Time::getMillisecondCounterHiRes() when it was sent
+};
+
+// Single producer (message thread), single consumer (audio thread) queue.
+// Both ends are wait-free -- AbstractFifo only moves two atomic indices -- and
+// the storage is fixed, so nothing allocates. A full queue drops the command.
+class CommandQueue
+{
+public:
+    static constexpr int capacity = 64;
+
+    bool push(const DelayCommand& command) noexcept {
+        auto scope = fifo.write(1);
+        if (scope.blockSize1 == 0)
+            return false;
+
+        commands[size_t(scope.startIndex1)] = command;
+        return true;
+    }
+
+    bool pop(DelayCommand& command) noexcept {
+        auto scope = fifo.read(1);
+        if (scope.blockSize1 == 0)
+            return false;
+
+        command = commands[size_t(scope.startIndex1)];
+        return true;
+    }
+
+private:
+    juce::AbstractFifo fifo{ capacity };
+    std::array<DelayCommand, capacity> commands{};
+};
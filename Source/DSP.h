@@ -4,8 +4,9 @@
 
 #include <cmath>
 
+#include "FastMath.h"
+
 inline void panningEqualPower(float panning, float& left, float& right) {
-	float x = PI / 4 * (panning + 1.0f); // panning -- -1 means all to the left and 1 to the right
-	left = std::cos(x);
-	right = std::sin(x);
+	float x = float(PI / 4) * (panning + 1.0f); // panning -- -1 means all to the left and 1 to the right
+	FastMath::sinCos(x, right, left); // x is always within [0, pi/2]
 }
\ No newline at end of file
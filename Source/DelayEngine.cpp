@@ -0,0 +1,205 @@
+#include "DelayEngine.h"
+
+#include <algorithm>
+
+DelayEngine::DelayEngine(int partitionSize)
+    : convolver(partitionSize)
+{
+    numStreams = 0;
+    numLanes = 0;
+    maxCutoff = 0.0f;
+
+    feedback = 0.0f;
+    shimmer = 0.0f;
+    wetTapOffset = 0.0f;
+    lowCut = -1.0f;
+    highCut = -1.0f;
+
+    frozen = false;
+    freezeGain = 0.0f;
+    freezeStep = 0.0f;
+
+    characterOn = false;
+    externalLine = nullptr;
+    externalDelay = 0.0f;
+
+    lowCutFilter.setType(StateVariableFilter::Type::highpass);
+    highCutFilter.setType(StateVariableFilter::Type::lowpass);
+}
+
+void DelayEngine::prepare(double sampleRate, int streams, int maxDelayInSamples) {
+    numStreams = streams;
+    numLanes = 2 * streams;
+
+    // at a reduced internal rate the cutoffs have to stay below its nyquist
+    maxCutoff = float(sampleRate) * 0.49f;
+
+    // the shimmer grains read up to one grain past the delay time
+    shifter.prepare(sampleRate, numLanes);
+    delayLine.prepare(numLanes, maxDelayInSamples + shifter.getHeadroom() + 1);
+
+    saturator.prepare(sampleRate, numLanes);
+    convolver.prepare(numLanes);
+    lowCutFilter.prepare(sampleRate, numLanes);
+    highCutFilter.prepare(sampleRate, numLanes);
+
+    freezeStep = float(1.0 / (0.05 * sampleRate)); // 50 ms crossfade
+
+    for (auto* frame : { &feedbackFrame, &lastTap, &inputFrame, &tapFrame, &wetFrame, &shiftedFrame })
+        frame->assign(size_t(numLanes), 0.0f);
+
+    reset();
+}
+
+size_t DelayEngine::getMemoryUsage() const noexcept {
+    return delayLine.getMemoryUsage() + saturator.getMemoryUsage()
+         + convolver.getMemoryUsage() + shifter.getMemoryUsage();
+}
+
+void DelayEngine::reset() noexcept {
+    delayLine.reset();
+    shifter.reset();
+    saturator.reset();
+    convolver.reset();
+    lowCutFilter.reset();
+    highCutFilter.reset();
+
+    std::fill(feedbackFrame.begin(), feedbackFrame.end(), 0.0f);
+    std::fill(lastTap.begin(), lastTap.end(), 0.0f);
+
+    lowCut = -1.0f;
+    highCut = -1.0f;
+    freezeGain = frozen ? 1.0f : 0.0f;
+    characterOn = false;
+    externalLine = nullptr;
+}
+
+void DelayEngine::clear() noexcept {
+    delayLine.clear();
+    convolver.reset();
+    saturator.reset();
+    lowCutFilter.reset();
+    highCutFilter.reset();
+
+    std::fill(feedbackFrame.begin(), feedbackFrame.end(), 0.0f);
+    std::fill(lastTap.begin(), lastTap.end(), 0.0f);
+}
+
+void DelayEngine::setLowCut(float hz) noexcept {
+    if (hz != lowCut) {
+        lowCutFilter.setCutoffFrequency(std::min(hz, maxCutoff));
+        lowCut = hz;
+    }
+}
+
+void DelayEngine::setHighCut(float hz) noexcept {
+    if (hz != highCut) {
+        highCutFilter.setCutoffFrequency(std::min(hz, maxCutoff));
+        highCut = hz;
+    }
+}
+
+void DelayEngine::setCharacterOn(bool shouldBeOn) noexcept {
+    // fresh history, so nothing from long ago comes back
+    if (shouldBeOn && !characterOn)
+        convolver.reset();
+    characterOn = shouldBeOn;
+}
+
+void DelayEngine::setExternalDelayLine(ExternalDelayLine* line, float delayInSamples) noexcept {
+    // both clears are constant time
+    if ((line != nullptr) != (externalLine != nullptr)) {
+        if (line != nullptr)
+            line->clear();
+        else
+            delayLine.clear();
+    }
+
+    externalLine = line;
+    externalDelay = delayInSamples;
+}
+
+void DelayEngine::process(const float* inputL, const float* inputR, float* wetL, float* wetR) noexcept {
+    const int n = numStreams;
+    float* in = inputFrame.data();
+    float* fb = feedbackFrame.data();
+    float* last = lastTap.data();
+
+    // what goes into the delay line, frozen it's just the last repeat going round again
+    float frozenTarget = frozen ? 1.0f : 0.0f;
+    if (freezeGain != frozenTarget)
+        freezeGain = frozen ? std::min(freezeGain + freezeStep, 1.0f) : std::max(freezeGain - freezeStep, 0.0f);
+
+    // ping pong -- every channel gets the other one's feedback
+    for (int s = 0; s < n; ++s) {
+        in[s] = inputL[s] + fb[n + s];
+        in[n + s] = inputR[s] + fb[s];
+    }
+
+    const float freeze = freezeGain; // locals here and below, the stores could alias the members
+    for (int s = 0; s < n; ++s) {
+        in[s] += (last[n + s] - in[s]) * freeze;
+        in[n + s] += (last[s] - in[n + s]) * freeze;
+    }
+
+    // what goes round the loop is read at the full delay, what's heard is read
+    // wetTapOffset earlier so it's on time once it's through the rate converter
+    float* tap = tapFrame.data();
+    float* wet = wetTapOffset > 0.0f ? wetFrame.data() : tap;
+
+    // shimmer -- grains read the same delay line, so it's only there for the engine's own line
+    bool useShimmer = externalLine == nullptr && shimmer > 0.0f;
+    float* shifted = shiftedFrame.data();
+
+    if (externalLine != nullptr) {
+        // read before push -- same result as the delay line's push then pop
+        if (wetTapOffset > 0.0f)
+            externalLine->read(externalDelay - wetTapOffset, wet);
+
+        externalLine->read(externalDelay, tap);
+        externalLine->push(in);
+    }
+    else {
+        // z^(-N)
+        delayLine.push(in);
+
+        // before the tap below moves the read pointer on, so the grains line up with it
+        if (useShimmer)
+            shifter.process(delayLine, delayLine.getDelay(), shifted);
+
+        if (wetTapOffset > 0.0f)
+            delayLine.read(std::max(delayLine.getDelay() - wetTapOffset, 0.0f), wet);
+
+        delayLine.pop(tap);
+    }
+
+    for (int lane = 0; lane < numLanes; ++lane)
+        last[lane] = tap[lane];
+
+    const float feedbackGain = feedback;
+    const float shimmerAmount = shimmer;
+
+    if (useShimmer) {
+        for (int lane = 0; lane < numLanes; ++lane)
+            fb[lane] = (tap[lane] + (shifted[lane] - tap[lane]) * shimmerAmount) * feedbackGain;
+    }
+    else {
+        for (int lane = 0; lane < numLanes; ++lane)
+            fb[lane] = tap[lane] * feedbackGain;
+    }
+
+    // tape-style drive -- bounds the loop so high feedback self-oscillates instead of running away
+    saturator.process(fb);
+
+    // tape head, speaker or spring -- adds no latency, so the loop length stays put
+    if (characterOn)
+        convolver.process(fb);
+
+    lowCutFilter.process(fb);
+    highCutFilter.process(fb);
+
+    for (int s = 0; s < n; ++s) {
+        wetL[s] = wet[s];
+        wetR[s] = wet[n + s];
+    }
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "DelayLineBank.h"
+#include "FeedbackConvolver.h"
+#include "FeedbackSaturator.h"
+#include "GrainShifter.h"
+#include "StateVariableFilter.h"
+
+// Delay storage the engine reads and writes in place of its own line, e.g. the
+// plug-in's long delay line that spills to disk. Frames are laid out like the
+// engine's, one sample per lane.
+class ExternalDelayLine
+{
+public:
+    virtual ~ExternalDelayLine() = default;
+
+    // audio thread -- read before push, delayInSamples >= 1
+    virtual void read(float delayInSamples, float* frame) noexcept = 0;
+    virtual void push(const float* frame) noexcept = 0;
+
+    // audio thread -- everything pushed so far reads back as silence
+    virtual void clear() noexcept = 0;
+};
+
+// The ping-pong feedback loop of the plug-in -- delay line, shimmer, drive,
+// character and the cut filters -- without JUCE, for any number of streams.
+//
+// All streams share the settings, so the read position, the grains, the filter
+// coefficients and the saturator's crossfade are shared as well. What every
+// stream has of its own is stored structure-of-arrays, one lane per channel and
+// stream: the left channels of all streams first, then the right ones. Every
+// stage runs one loop over the lanes per sample, which the compiler vectorizes
+// across streams.
+//
+// DelayAudioProcessor runs it with one stream at the internal rate.
+class DelayEngine
+{
+public:
+    // the convolver's tail is worked out every partitionSize samples, a power of two
+    explicit DelayEngine(int partitionSize);
+
+    // ======= not on the audio thread =======
+    // allocates the delay line and the state of every stream, then resets.
+    // Call setOversampling() first, the saturator starts out at that factor
+    void prepare(double sampleRate, int numStreams, int maxDelayInSamples);
+
+    int getNumStreams() const noexcept { return numStreams; }
+
+    // bytes held by the delay line, the saturator, the convolver and the shifter --
+    // the convolver's kernels and the few floats of filter state aren't counted
+    size_t getMemoryUsage() const noexcept;
+
+    // the character's impulse response, see FeedbackConvolver
+    void setImpulseResponse(const std::vector<float>& impulseResponse) {
+        convolver.setKernel(convolver.createKernel(impulseResponse));
+    }
+
+    // frees the kernel the audio thread swapped out, call regularly
+    void releaseRetired() { convolver.releaseRetired(); }
+
+    // ======= audio thread =======
+    // back to the state right after prepare(), except for the settings
+    void reset() noexcept;
+
+    // kills every repeat at once -- the delay line is marked silent instead of zeroed,
+    // the rest is small enough to reset right away. An external line isn't touched
+    void clear() noexcept;
+
+    // ======= settings, audio thread =======
+    // in samples, without the saturator's latency -- take getLatency() off
+    void setDelay(float delayInSamples) noexcept { delayLine.setDelay(delayInSamples); }
+    float getDelay() const noexcept { return delayLine.getDelay(); }
+
+    void setFeedback(float gain) noexcept { feedback = gain; }
+
+    // Hz, kept below nyquist; nothing is recalculated while a cutoff stays the same
+    void setLowCut(float hz) noexcept;
+    void setHighCut(float hz) noexcept;
+
+    // 1 bypasses the drive, see FeedbackSaturator
+    void setOversampling(int factor) noexcept { saturator.setOversampling(factor); }
+    void setDrive(float gain) noexcept { saturator.setDrive(gain); }
+
+    // latency of the drive in samples, changes along with the oversampling
+    float getLatency() const noexcept { return saturator.getLatency(); }
+    bool isSwitching() const noexcept { return saturator.isSwitching(); }
+
+    // the convolver's history starts out empty every time it's switched on
+    void setCharacterOn(bool shouldBeOn) noexcept;
+
+    // 0 to 1, only for the engine's own delay line
+    void setShimmer(float amount) noexcept { shimmer = amount; }
+    void setPitch(float semitones) noexcept { shifter.setPitch(semitones); }
+
+    // the loop keeps circulating what's in the delay line, the input is faded out
+    void setFrozen(bool shouldBeFrozen) noexcept { frozen = shouldBeFrozen; }
+
+    // the wet output is read this much earlier than what goes round the loop
+    void setWetTapOffset(float samples) noexcept { wetTapOffset = samples; }
+
+    // nullptr for the engine's own delay line. The line that gets switched to is cleared,
+    // it wasn't written while the other one was in use
+    void setExternalDelayLine(ExternalDelayLine* line, float delayInSamples) noexcept;
+
+    // one sample of every stream, numStreams values per array
+    void process(const float* inputL, const float* inputR, float* wetL, float* wetR) noexcept;
+
+private:
+    int numStreams;
+    int numLanes; // 2 * numStreams, the left channels first
+    float maxCutoff;
+
+    // ======= shared by all streams =======
+    float feedback;
+    float shimmer;
+    float wetTapOffset;
+    float lowCut; // last cutoffs handed to the filters, -1 before the first
+    float highCut;
+
+    bool frozen;
+    float freezeGain; // 0 = normal, 1 = frozen
+    float freezeStep;
+
+    bool characterOn;
+
+    ExternalDelayLine* externalLine; // read instead of delayLine while it's set
+    float externalDelay;
+
+    // ======= one lane per channel and stream =======
+    DelayLineBank delayLine;
+    GrainShifter shifter; // pitch-shifted repeats, reads from delayLine
+    FeedbackSaturator saturator; // oversampled drive
+    FeedbackConvolver convolver; // impulse response per repeat
+
+    // filters -- opposite than expected types
+    StateVariableFilter lowCutFilter;
+    StateVariableFilter highCutFilter;
+
+    std::vector<float> feedbackFrame; // what goes back into the delay line
+    std::vector<float> lastTap;       // what went round last, frozen it goes round again
+    std::vector<float> inputFrame;
+    std::vector<float> tapFrame;
+    std::vector<float> wetFrame;
+    std::vector<float> shiftedFrame;
+};
@@ -0,0 +1,39 @@
+#include "DelayLineBank.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+DelayLineBank::DelayLineBank() {
+    numLanes = 0;
+    totalSize = 4;
+    delay = 0.0f;
+    delayFrac = 0.0f;
+    delayInt = 0;
+
+    reset();
+}
+
+void DelayLineBank::prepare(int lanes, int maxDelayInSamples) {
+    assert(lanes > 0 && maxDelayInSamples >= 0);
+    numLanes = lanes;
+    totalSize = std::max(4, maxDelayInSamples + 2);
+
+    buffer.assign(size_t(totalSize) * size_t(numLanes), 0.0f);
+    silence.assign(size_t(numLanes), 0.0f);
+
+    reset();
+}
+
+void DelayLineBank::reset() noexcept {
+    std::fill(buffer.begin(), buffer.end(), 0.0f);
+    writePos = 0;
+    readPos = 0;
+    fresh = totalSize;
+}
+
+void DelayLineBank::setDelay(float newDelayInSamples) noexcept {
+    delay = clampDelay(newDelayInSamples);
+    delayInt = int(std::floor(delay));
+    delayFrac = delay - float(delayInt);
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// A delay line per lane with linear interpolation, all lanes moving in step.
+//
+// Every lane reads like juce::dsp::DelayLine<float, Linear>, but they share one
+// write and one read position and a frame -- one sample per lane -- is stored in
+// one piece, so pushing and reading a frame are plain loops over the lanes that
+// vectorize. clear() doesn't zero the buffer (several megabytes at long delay
+// times), it only remembers how many frames were pushed since and everything
+// older reads as silence, so it's constant time on the audio thread.
+class DelayLineBank
+{
+public:
+    DelayLineBank();
+
+    // not on the audio thread -- allocates
+    void prepare(int numLanes, int maxDelayInSamples);
+    int getMaximumDelayInSamples() const noexcept { return totalSize - 2; }
+    int getNumLanes() const noexcept { return numLanes; }
+
+    // bytes held by all lanes
+    size_t getMemoryUsage() const noexcept { return buffer.capacity() * sizeof(float); }
+
+    void reset() noexcept;
+
+    // everything pushed so far reads back as silence
+    void clear() noexcept { fresh = 0; }
+
+    void setDelay(float newDelayInSamples) noexcept;
+    float getDelay() const noexcept { return delay; }
+
+    void push(const float* frame) noexcept {
+        float* slot = buffer.data() + size_t(writePos) * size_t(numLanes);
+        for (int lane = 0; lane < numLanes; ++lane)
+            slot[lane] = frame[lane];
+
+        writePos = (writePos + totalSize - 1) % totalSize;
+
+        if (fresh < totalSize)
+            ++fresh;
+    }
+
+    // at the delay set last, then moves the read position on
+    void pop(float* frame) noexcept {
+        read(delayInt, delayFrac, frame);
+        readPos = (readPos + totalSize - 1) % totalSize;
+    }
+
+    // at any other delay, clamped like setDelay() -- the delay and the read position stay where they are
+    void read(float delayInSamples, float* frame) const noexcept {
+        float clamped = clampDelay(delayInSamples);
+        int whole = int(clamped);
+        read(whole, clamped - float(whole), frame);
+    }
+
+private:
+    float clampDelay(float delayInSamples) const noexcept {
+        float maxDelay = float(getMaximumDelayInSamples());
+        return delayInSamples < 0.0f ? 0.0f : (delayInSamples > maxDelay ? maxDelay : delayInSamples);
+    }
+
+    void read(int whole, float fraction, float* frame) const noexcept {
+        int index1 = readPos + whole;
+        int index2 = index1 + 1;
+
+        if (index2 >= totalSize) {
+            index1 %= totalSize;
+            index2 %= totalSize;
+        }
+
+        const float* values1 = buffer.data() + size_t(index1) * size_t(numLanes);
+        const float* values2 = buffer.data() + size_t(index2) * size_t(numLanes);
+
+        // after a clear() only the frames pushed since are real
+        if (fresh < totalSize) {
+            values1 = isFresh(index1) ? values1 : silence.data();
+            values2 = isFresh(index2) ? values2 : silence.data();
+        }
+
+        for (int lane = 0; lane < numLanes; ++lane)
+            frame[lane] = values1[lane] + fraction * (values2[lane] - values1[lane]);
+    }
+
+    bool isFresh(int index) const noexcept {
+        // the newest frame sits one past the write position
+        int age = (index - writePos - 1 + totalSize) % totalSize;
+        return age < fresh;
+    }
+
+    std::vector<float> buffer; // totalSize frames of numLanes samples
+    std::vector<float> silence; // one frame of zeros, read in place of stale frames
+    int numLanes;
+    int totalSize;
+
+    int writePos;
+    int readPos;
+    int fresh; // frames pushed since the last clear(), stops counting at totalSize
+
+    float delay;
+    float delayFrac;
+    int delayInt;
+};
@@ -0,0 +1,101 @@
+#pragma once
+
+// Branch-free approximations of the transcendental functions on the parameter
+// and DSP path. They are inline and only use arithmetic and bit casts, so loops that
+// call them still auto-vectorize.
+//
+// Build with DELAY_FAST_MATH=0 to fall back to the exact <cmath> versions,
+// e.g. to rule them out when chasing a sound difference.
+//
+// Error bounds (measured against double precision over the stated ranges):
+//   sinCos          x in [0, pi/2]        abs error < 4e-6
+//   exp             x in [-80, 80]        rel error < 4e-6 (mostly rounding of x * log2(e))
+//   tan             x in [0, 1.54]        rel error < 4e-6 -- cutoffs up to 0.49 * fs
+//   decibelsToGain  dB in [-99, 12]       rel error < 1e-6
+//   tanh            any x                 abs error < 1e-6
+
+#ifndef DELAY_FAST_MATH
+    #define DELAY_FAST_MATH 1
+#endif
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace FastMath
+{
+    constexpr float halfPi = 1.57079632679f;
+    constexpr float ln2 = 0.69314718056f;
+    constexpr float log2e = 1.44269504089f;
+
+#if DELAY_FAST_MATH
+
+    inline float bitsToFloat(std::int32_t bits) noexcept {
+        float f;
+        std::memcpy(&f, &bits, sizeof(f));
+        return f;
+    }
+
+    // odd Taylor polynomial of sin, accurate on [-pi/2, pi/2]
+    inline float sinQuarter(float x) noexcept {
+        float x2 = x * x;
+        return x * (1.0f + x2 * (-1.0f / 6.0f + x2 * (1.0f / 120.0f
+                 + x2 * (-1.0f / 5040.0f + x2 * (1.0f / 362880.0f)))));
+    }
+
+    // x in [0, pi/2] -- the range equal-power panning needs
+    inline void sinCos(float x, float& sine, float& cosine) noexcept {
+        sine = sinQuarter(x);
+        cosine = sinQuarter(halfPi - x);
+    }
+
+    // 2^x = 2^i * e^(f * ln2) with f in [-0.5, 0.5]
+    inline float exp2(float x) noexcept {
+        x = x < -126.0f ? -126.0f : (x > 126.0f ? 126.0f : x);
+        std::int32_t i = std::int32_t(x + (x >= 0.0f ? 0.5f : -0.5f)); // round to nearest
+        float f = (x - float(i)) * ln2;
+        float p = 1.0f + f * (1.0f + f * (1.0f / 2.0f + f * (1.0f / 6.0f
+                + f * (1.0f / 24.0f + f * (1.0f / 120.0f + f * (1.0f / 720.0f))))));
+        return p * bitsToFloat((i + 127) << 23);
+    }
+
+    inline float exp(float x) noexcept {
+        return exp2(x * log2e);
+    }
+
+    // x in [0, pi/2), mostly used as tan(pi * cutoff / sampleRate)
+    inline float tan(float x) noexcept {
+        float s, c;
+        sinCos(x, s, c);
+        return s / c;
+    }
+
+    // same behaviour as juce::Decibels, anything at or below -100 dB is silence
+    inline float decibelsToGain(float decibels) noexcept {
+        float gain = exp2(decibels * (3.32192809489f / 20.0f)); // log2(10) / 20
+        return decibels > -100.0f ? gain : 0.0f;
+    }
+
+    // exp() saturates at 2^126 for big inputs, so this settles at +/-1 without a branch
+    inline float tanh(float x) noexcept {
+        return 1.0f - 2.0f / (1.0f + exp(2.0f * x));
+    }
+
+#else
+
+    inline void sinCos(float x, float& sine, float& cosine) noexcept {
+        sine = std::sin(x);
+        cosine = std::cos(x);
+    }
+
+    inline float exp2(float x) noexcept { return std::exp2(x); }
+    inline float exp(float x) noexcept { return std::exp(x); }
+    inline float tan(float x) noexcept { return std::tan(x); }
+    inline float tanh(float x) noexcept { return std::tanh(x); }
+
+    inline float decibelsToGain(float decibels) noexcept {
+        return decibels > -100.0f ? std::pow(10.0f, decibels * 0.05f) : 0.0f;
+    }
+
+#endif
+}
@@ -0,0 +1,304 @@
+#include "FeedbackConvolver.h"
+#include "DSP.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+static int fftOrderFor(int partitionSize) {
+    assert(partitionSize > 1 && (partitionSize & (partitionSize - 1)) == 0); // a power of two
+    return int(std::lround(std::log2(double(2 * partitionSize))));
+}
+
+FeedbackConvolver::FeedbackConvolver(int size)
+    : partitionSize(size),
+      numBins(size + 1),
+      maxPartitions(std::max(1, maxLength / size - 1)),
+      fft(fftOrderFor(size))
+{
+    fftData.resize(size_t(4 * partitionSize)); // 2 * fft size, what the real-only transforms want
+
+    numLanes = 0;
+    current = nullptr;
+    reset();
+}
+
+FeedbackConvolver::~FeedbackConvolver() {
+    delete current;
+    delete incoming.exchange(nullptr);
+    delete retired.exchange(nullptr);
+}
+
+// ======= message thread =======
+std::unique_ptr<FeedbackConvolver::Kernel> FeedbackConvolver::createKernel(const std::vector<float>& impulseResponse) const {
+    auto kernel = std::make_unique<Kernel>();
+    int length = std::min(int(impulseResponse.size()), maxLength);
+    auto tap = [&](int i) { return i < length ? impulseResponse[size_t(i)] : 0.0f; };
+
+    kernel->head.resize(size_t(partitionSize));
+    for (int i = 0; i < partitionSize; ++i)
+        kernel->head[size_t(i)] = tap(i);
+
+    kernel->numPartitions = std::min(maxPartitions, std::max(0, (length - 1) / partitionSize));
+    kernel->tail.resize(size_t(kernel->numPartitions * 2 * numBins));
+
+    // own FFT object, the audio thread's one is never shared
+    RealFFT kernelFFT(fftOrderFor(partitionSize));
+    std::vector<float> data(size_t(4 * partitionSize));
+
+    for (int p = 0; p < kernel->numPartitions; ++p) {
+        std::fill(data.begin(), data.end(), 0.0f);
+        for (int i = 0; i < partitionSize; ++i)
+            data[size_t(i)] = tap((p + 1) * partitionSize + i);
+
+        kernelFFT.performRealOnlyForwardTransform(data.data());
+        std::copy(data.begin(), data.begin() + 2 * numBins, kernel->tail.begin() + p * 2 * numBins);
+    }
+
+    return kernel;
+}
+
+void FeedbackConvolver::setKernel(std::unique_ptr<Kernel> kernel) {
+    delete incoming.exchange(kernel.release(), std::memory_order_acq_rel);
+}
+
+void FeedbackConvolver::prepare(int lanes) {
+    numLanes = lanes;
+    headHistory.resize(size_t(2 * partitionSize * numLanes));
+    oddSums.resize(size_t(numLanes));
+
+    inputWindow.resize(size_t(2 * partitionSize * numLanes));
+    tailOutput.resize(size_t(partitionSize * numLanes));
+    spectra.resize(size_t(maxPartitions * 2 * numBins * numLanes));
+
+    reset();
+}
+
+void FeedbackConvolver::releaseRetired() {
+    delete retired.exchange(nullptr, std::memory_order_acq_rel);
+}
+
+size_t FeedbackConvolver::getMemoryUsage() const noexcept {
+    size_t numFloats = headHistory.capacity() + oddSums.capacity() + fftData.capacity()
+                     + inputWindow.capacity() + tailOutput.capacity() + spectra.capacity();
+    return numFloats * sizeof(float);
+}
+
+std::vector<float> FeedbackConvolver::makeImpulseResponse(Character character, double sampleRate) {
+    auto seconds = [&](double s) { return std::min(maxLength, std::max(1, int(s * sampleRate))); };
+
+    auto addDampedSine = [&](std::vector<float>& ir, double freq, double decaySeconds, double amplitude) {
+        double w = 2.0 * PI * freq / sampleRate;
+        double decay = std::exp(-1.0 / (decaySeconds * sampleRate));
+        double envelope = amplitude;
+        for (size_t n = 0; n < ir.size(); ++n) {
+            ir[n] += float(envelope * std::sin(w * double(n)));
+            envelope *= decay;
+        }
+    };
+
+    // one-pole low-pass run over the whole response
+    auto darken = [&](std::vector<float>& ir, double cutoff) {
+        double a = std::exp(-2.0 * PI * cutoff / sampleRate);
+        double z = 0.0;
+        for (auto& x : ir) {
+            z = double(x) * (1.0 - a) + z * a;
+            x = float(z);
+        }
+    };
+
+    // one-pole high-pass, same kind
+    auto thin = [&](std::vector<float>& ir, double cutoff) {
+        double a = std::exp(-2.0 * PI * cutoff / sampleRate);
+        double z = 0.0, previous = 0.0;
+        for (auto& x : ir) {
+            z = a * (z + double(x) - previous);
+            previous = double(x);
+            x = float(z);
+        }
+    };
+
+    std::vector<float> ir;
+
+    switch (character) {
+        case off:
+            ir = { 1.0f };
+            break;
+
+        case tape: // high frequency loss plus the head bump
+            ir.assign(size_t(seconds(0.04)), 0.0f);
+            ir[0] = 1.0f;
+            darken(ir, 7000.0);
+            addDampedSine(ir, 90.0, 0.008, 0.02);
+            break;
+
+        case speaker: // no lows, a couple of cone resonances, nothing above 5 kHz
+            ir.assign(size_t(seconds(0.02)), 0.0f);
+            ir[0] = 1.0f;
+            addDampedSine(ir, 140.0, 0.006, 0.03);
+            addDampedSine(ir, 1800.0, 0.001, 0.25);
+            addDampedSine(ir, 3500.0, 0.0005, 0.15);
+            darken(ir, 5000.0);
+            thin(ir, 120.0);
+            break;
+
+        case spring: // dispersive chirps falling from 4 kHz, repeating as they bounce along the spring
+        {
+            ir.assign(size_t(seconds(0.085)), 0.0f);
+            double bounce = 0.027;
+            double chirpLength = 0.02;
+            for (int echo = 0; echo < 4; ++echo) {
+                double start = echo * bounce;
+                double gain = std::pow(0.55, echo);
+                for (size_t n = 0; n < ir.size(); ++n) {
+                    double t = double(n) / sampleRate - start;
+                    if (t < 0.0 || t > chirpLength)
+                        continue;
+                    double phase = 2.0 * PI * (4000.0 * t - 0.5 * (3500.0 / chirpLength) * t * t);
+                    ir[n] += float(gain * 0.2 * std::sin(phase) * std::exp(-t / 0.006));
+                }
+            }
+            ir[0] += 0.6f;
+            darken(ir, 6000.0);
+            break;
+        }
+    }
+
+    // peak of the magnitude response to 1, the IR never adds gain to the loop
+    RealFFT analysis(14);
+    int numSamples = analysis.getSize();
+    std::vector<float> data(size_t(2 * numSamples), 0.0f);
+    std::copy(ir.begin(), ir.begin() + std::min(ir.size(), size_t(numSamples)), data.begin());
+    analysis.performRealOnlyForwardTransform(data.data());
+
+    float peak = 0.0f;
+    for (int k = 0; k <= numSamples / 2; ++k)
+        peak = std::max(peak, std::hypot(data[size_t(2 * k)], data[size_t(2 * k + 1)]));
+
+    if (peak > 0.0f)
+        for (auto& x : ir)
+            x /= peak;
+
+    return ir;
+}
+
+// ======= audio thread =======
+void FeedbackConvolver::reset() noexcept {
+    std::fill(headHistory.begin(), headHistory.end(), 0.0f);
+    std::fill(inputWindow.begin(), inputWindow.end(), 0.0f);
+    std::fill(tailOutput.begin(), tailOutput.end(), 0.0f);
+    std::fill(spectra.begin(), spectra.end(), 0.0f);
+    headPos = 0;
+    blockPos = 0;
+    spectrumSlot = 0;
+}
+
+// the message thread frees the old kernel, so nothing is deleted here;
+// the previous one has to be collected before the next swap
+void FeedbackConvolver::swapKernel() noexcept {
+    if (retired.load(std::memory_order_acquire) != nullptr)
+        return;
+
+    Kernel* next = incoming.exchange(nullptr, std::memory_order_acq_rel);
+    if (next == nullptr)
+        return;
+
+    retired.store(current, std::memory_order_release);
+    current = next;
+}
+
+void FeedbackConvolver::process(float* frame) noexcept {
+    // newest frame first, written twice so the window from headPos never wraps
+    headPos = (headPos == 0 ? partitionSize : headPos) - 1;
+    float* first = headHistory.data() + headPos * numLanes;
+    float* second = headHistory.data() + (headPos + partitionSize) * numLanes;
+
+    for (int lane = 0; lane < numLanes; ++lane) {
+        first[lane] = frame[lane];
+        second[lane] = frame[lane];
+        inputWindow[size_t(lane * 2 * partitionSize + partitionSize + blockPos)] = frame[lane];
+    }
+
+    if (current != nullptr) {
+        // the lanes are independent, even and odd taps summed apart like HalfBandStage::convolve;
+        // frame is already in the history, so it holds the even sums
+        float* evenSum = frame;
+        float* oddSum = oddSums.data();
+        std::fill(evenSum, evenSum + numLanes, 0.0f);
+        std::fill(oddSum, oddSum + numLanes, 0.0f);
+
+        const float* c = current->head.data();
+        for (int i = 0; i < partitionSize; i += 2) {
+            const float* even = first + i * numLanes;
+            const float* odd = even + numLanes;
+
+            for (int lane = 0; lane < numLanes; ++lane) {
+                evenSum[lane] += c[i] * even[lane];
+                oddSum[lane] += c[i + 1] * odd[lane];
+            }
+        }
+
+        const float* tail = tailOutput.data() + blockPos;
+        for (int lane = 0; lane < numLanes; ++lane)
+            frame[lane] = evenSum[lane] + oddSum[lane] + tail[lane * partitionSize];
+    }
+
+    if (++blockPos == partitionSize) {
+        blockPos = 0;
+        processPartition();
+    }
+}
+
+// runs once per partition: transforms the finished block and computes the tail for the next one
+void FeedbackConvolver::processPartition() noexcept {
+    swapKernel();
+
+    int numPartitions = current != nullptr ? current->numPartitions : 0;
+    const int numValues = 2 * numBins;
+
+    for (int lane = 0; lane < numLanes; ++lane) {
+        float* window = inputWindow.data() + lane * 2 * partitionSize;
+        float* output = tailOutput.data() + lane * partitionSize;
+        float* laneSpectra = spectra.data() + lane * maxPartitions * numValues;
+
+        // overlap-save -- the previous and the finished block
+        std::copy(window, window + 2 * partitionSize, fftData.begin());
+        std::fill(fftData.begin() + 2 * partitionSize, fftData.end(), 0.0f);
+        fft.performRealOnlyForwardTransform(fftData.data());
+
+        float* slot = laneSpectra + spectrumSlot * numValues;
+        std::copy(fftData.begin(), fftData.begin() + numValues, slot);
+
+        std::copy(window + partitionSize, window + 2 * partitionSize, window);
+
+        if (numPartitions == 0) {
+            std::fill(output, output + partitionSize, 0.0f);
+            continue;
+        }
+
+        // multiply-accumulate the block p partitions back with partition p of the tail
+        float* acc = fftData.data();
+        std::fill(acc, acc + numValues, 0.0f);
+
+        for (int p = 0; p < numPartitions; ++p) {
+            int index = spectrumSlot - p;
+            if (index < 0)
+                index += maxPartitions;
+
+            const float* x = laneSpectra + index * numValues;
+            const float* h = current->tail.data() + p * numValues;
+
+            for (int k = 0; k < numValues; k += 2) {
+                acc[k] += x[k] * h[k] - x[k + 1] * h[k + 1];
+                acc[k + 1] += x[k] * h[k + 1] + x[k + 1] * h[k];
+            }
+        }
+
+        fft.performRealOnlyInverseTransform(fftData.data());
+
+        // the tail starts one partition in, so this is its output for the block that starts now
+        std::copy(fftData.begin() + partitionSize, fftData.begin() + 2 * partitionSize, output);
+    }
+
+    spectrumSlot = (spectrumSlot + 1) % maxPartitions;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "RealFFT.h"
+
+// Short impulse response applied to every repeat inside the feedback loop.
+//
+// The first partition of the IR runs as a direct FIR, so the stage has no
+// latency and the loop still closes sample by sample at any delay time. The
+// rest of the IR is a uniformly partitioned overlap-save convolution whose
+// partition size equals the processor's sub-block size: at every partition
+// boundary the block that just finished is transformed and multiplied with all
+// tail partitions, which gives the tail's output for the next block.
+//
+// Kernels are built and transformed on the message thread and handed over
+// through an atomic pointer, the audio thread swaps them at a partition boundary.
+// Every lane of a frame -- channels of one or many streams -- is convolved with
+// the same kernel and keeps its own history.
+class FeedbackConvolver
+{
+public:
+    // matches the items of the "Character" parameter
+    enum Character { off, tape, speaker, spring };
+
+    // transformed impulse response, only created through createKernel()
+    struct Kernel
+    {
+        std::vector<float> head; // first partition
+        std::vector<float> tail; // spectrum of every further partition, interleaved re/im
+        int numPartitions = 0;   // tail partitions
+    };
+
+    explicit FeedbackConvolver(int partitionSize);
+    ~FeedbackConvolver();
+
+    FeedbackConvolver(const FeedbackConvolver&) = delete;
+    FeedbackConvolver& operator=(const FeedbackConvolver&) = delete;
+
+    // ======= message thread =======
+    // allocates the history of every lane, also resets
+    void prepare(int numLanes);
+
+    // procedural impulse response for one of the characters, peak gain normalized to 1
+    static std::vector<float> makeImpulseResponse(Character character, double sampleRate);
+
+    // splits and transforms an IR, longer ones are cut at maxLength
+    std::unique_ptr<Kernel> createKernel(const std::vector<float>& impulseResponse) const;
+
+    // the audio thread picks it up at the next partition boundary, replaces a kernel that wasn't picked up yet
+    void setKernel(std::unique_ptr<Kernel> kernel);
+
+    // frees the kernel the audio thread swapped out, call regularly
+    void releaseRetired();
+
+    // bytes of history and scratch, fixed by prepare() -- kernels aren't counted
+    size_t getMemoryUsage() const noexcept;
+
+    // ======= audio thread =======
+    void reset() noexcept;
+
+    // in place, one sample per lane -- passes the signal through until the first kernel has arrived
+    void process(float* frame) noexcept;
+
+    // ======= constants =======
+    static constexpr int maxLength = 4096; // samples
+
+private:
+    void processPartition() noexcept;
+    void swapKernel() noexcept;
+
+    const int partitionSize;
+    const int numBins;       // partitionSize + 1 complex bins of a 2 * partitionSize FFT
+    const int maxPartitions; // tail partitions that fit into maxLength
+    int numLanes;
+
+    RealFFT fft; // audio thread only, createKernel() uses its own
+
+    // frames newest first, stored twice so the head FIR's window is always contiguous
+    std::vector<float> headHistory;
+    int headPos;
+    std::vector<float> oddSums; // per lane, odd taps summed apart from the even ones
+
+    // per lane, one after the other: the last two blocks of input, the output of the tail
+    // and the spectra of the last maxPartitions input blocks -- a frequency-domain delay line
+    std::vector<float> inputWindow;
+    std::vector<float> tailOutput;
+    std::vector<float> spectra;
+    std::vector<float> fftData; // scratch for the transforms
+    int spectrumSlot;
+
+    int blockPos;
+
+    Kernel* current; // owned, audio thread only
+    std::atomic<Kernel*> incoming{ nullptr };
+    std::atomic<Kernel*> retired{ nullptr };
+};
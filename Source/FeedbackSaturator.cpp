@@ -0,0 +1,215 @@
+#include "FeedbackSaturator.h"
+#include "FastMath.h"
+#include "DSP.h"
+
+#include <algorithm>
+#include <cmath>
+
+// ========== HalfBandStage ==========
+static double besselI0(double x) {
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 32; ++k) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+HalfBandStage::HalfBandStage(int filterOrder) {
+    order = filterOrder;
+
+    // Kaiser windowed sinc with the cutoff at a quarter of the high sample rate, 4 * order - 1 taps
+    int centre = 2 * order - 1;
+    double beta = 8.0;
+
+    // only the taps at odd distances from the centre are non-zero, 2 * order of them;
+    // the factor 2 makes up for the zeros stuffed in by the upsampler
+    coefficients.resize(size_t(2 * order));
+    for (int j = 0; j < 2 * order; ++j) {
+        int n = 2 * j; // even index -> odd distance from the centre
+        double x = double(n - centre) * 0.5;
+        double sinc = std::sin(PI * x) / (PI * x);
+        double ratio = double(n - centre) / double(centre + 1);
+        double window = besselI0(beta * std::sqrt(std::max(0.0, 1.0 - ratio * ratio))) / besselI0(beta);
+        coefficients[size_t(j)] = float(2.0 * 0.5 * sinc * window);
+    }
+
+    numLanes = 0;
+    evenPos = 0;
+    oddPos = 0;
+}
+
+void HalfBandStage::setNumLanes(int lanes) {
+    numLanes = lanes;
+    evenHistory.resize(size_t(4 * order * numLanes));
+    oddHistory.resize(size_t(2 * order * numLanes));
+    sums.resize(size_t(2 * numLanes));
+    reset();
+}
+
+void HalfBandStage::reset() noexcept {
+    std::fill(evenHistory.begin(), evenHistory.end(), 0.0f);
+    std::fill(oddHistory.begin(), oddHistory.end(), 0.0f);
+    evenPos = 0;
+    oddPos = 0;
+}
+
+// newest frame first, written twice so history[pos .. pos + length) never wraps
+void HalfBandStage::push(std::vector<float>& history, int& pos, int length, const float* frame) noexcept {
+    pos = (pos == 0 ? length : pos) - 1;
+    float* first = history.data() + pos * numLanes;
+    float* second = history.data() + (pos + length) * numLanes;
+
+    for (int lane = 0; lane < numLanes; ++lane) {
+        first[lane] = frame[lane];
+        second[lane] = frame[lane];
+    }
+}
+
+void HalfBandStage::convolve(const float* history, float* out) noexcept {
+    // the lanes are independent, so this vectorizes across them without reassociating
+    // sums; even and odd taps are summed apart, two chains of adds instead of one
+    float* evenSum = out;
+    float* oddSum = sums.data();
+    std::fill(evenSum, evenSum + numLanes, 0.0f);
+    std::fill(oddSum, oddSum + numLanes, 0.0f);
+
+    const float* c = coefficients.data();
+    for (int j = 0; j < 2 * order; j += 2) {
+        const float* even = history + j * numLanes;
+        const float* odd = even + numLanes;
+
+        for (int lane = 0; lane < numLanes; ++lane) {
+            evenSum[lane] += c[j] * even[lane];
+            oddSum[lane] += c[j + 1] * odd[lane];
+        }
+    }
+
+    for (int lane = 0; lane < numLanes; ++lane)
+        out[lane] = evenSum[lane] + oddSum[lane];
+}
+
+void HalfBandStage::upsample(const float* in, float* out) noexcept {
+    push(evenHistory, evenPos, 2 * order, in);
+
+    // even phase -- the non-zero taps
+    convolve(evenHistory.data() + evenPos * numLanes, out);
+
+    // odd phase -- only the centre tap (0.5 * 2), a delay of order - 1 frames
+    const float* delayed = evenHistory.data() + (evenPos + order - 1) * numLanes;
+    std::copy(delayed, delayed + numLanes, out + numLanes);
+}
+
+void HalfBandStage::downsample(const float* in, float* out) noexcept {
+    push(evenHistory, evenPos, 2 * order, in);
+    convolve(evenHistory.data() + evenPos * numLanes, out);
+
+    // centre tap on the odd samples, order frames back
+    const float* delayed = oddHistory.data() + (oddPos + order - 1) * numLanes;
+    for (int lane = 0; lane < numLanes; ++lane)
+        out[lane] = 0.5f * (out[lane] + delayed[lane]);
+
+    push(oddHistory, oddPos, order, in + numLanes);
+}
+
+// ========== FeedbackSaturator ==========
+FeedbackSaturator::FeedbackSaturator()
+    : stage1Up(8), stage1Down(8), stage2Up(4), stage2Down(4)
+{
+    factor = 2;
+    targetFactor = 2;
+    fadeGain = 1.0f;
+    fadeStep = 1.0f / 220.0f;
+    drive = 1.0f;
+    numLanes = 0;
+}
+
+void FeedbackSaturator::prepare(double sampleRate, int lanes) {
+    fadeStep = float(1.0 / (0.005 * sampleRate)); // 5 ms each way
+
+    numLanes = lanes;
+    stage1Up.setNumLanes(numLanes);
+    stage1Down.setNumLanes(numLanes);
+    stage2Up.setNumLanes(numLanes);
+    stage2Down.setNumLanes(numLanes);
+
+    up2.resize(size_t(2 * numLanes));
+    up4.resize(size_t(4 * numLanes));
+    saturated.resize(size_t(numLanes));
+}
+
+void FeedbackSaturator::reset() noexcept {
+    factor = targetFactor;
+    fadeGain = factor > 1 ? 1.0f : 0.0f;
+    resetStages();
+}
+
+void FeedbackSaturator::resetStages() noexcept {
+    stage1Up.reset();
+    stage1Down.reset();
+    stage2Up.reset();
+    stage2Down.reset();
+}
+
+void FeedbackSaturator::setOversampling(int newFactor) noexcept {
+    targetFactor = newFactor >= 4 ? 4 : newFactor >= 2 ? 2 : 1;
+}
+
+float FeedbackSaturator::getLatency() const noexcept {
+    if (factor == 1)
+        return 0.0f;
+
+    float latency = stage1Up.getLatency() + stage1Down.getLatency();
+    if (factor == 4)
+        latency += (stage2Up.getLatency() + stage2Down.getLatency()) * 0.5f; // runs at 2x
+    return latency;
+}
+
+size_t FeedbackSaturator::getMemoryUsage() const noexcept {
+    return stage1Up.getMemoryUsage() + stage1Down.getMemoryUsage()
+         + stage2Up.getMemoryUsage() + stage2Down.getMemoryUsage()
+         + (up2.capacity() + up4.capacity() + saturated.capacity()) * sizeof(float);
+}
+
+void FeedbackSaturator::process(float* frame) noexcept {
+    // a switch waits until the output is all clean signal, then starts from empty filters
+    if (factor != targetFactor) {
+        fadeGain = std::max(fadeGain - fadeStep, 0.0f);
+        if (fadeGain == 0.0f) {
+            factor = targetFactor;
+            resetStages();
+        }
+    }
+    else if (fadeGain < 1.0f && factor > 1) {
+        fadeGain = std::min(fadeGain + fadeStep, 1.0f);
+    }
+
+    if (factor == 1)
+        return;
+
+    // two frames at 2x, then four at 4x
+    float* x2 = up2.data();
+    stage1Up.upsample(frame, x2);
+
+    if (factor == 4) {
+        float* x4 = up4.data();
+        stage2Up.upsample(x2, x4);
+        stage2Up.upsample(x2 + numLanes, x4 + 2 * numLanes);
+
+        for (int i = 0; i < 4 * numLanes; ++i)
+            x4[i] = FastMath::tanh(drive * x4[i]);
+
+        stage2Down.downsample(x4, x2);
+        stage2Down.downsample(x4 + 2 * numLanes, x2 + numLanes);
+    }
+    else {
+        for (int i = 0; i < 2 * numLanes; ++i)
+            x2[i] = FastMath::tanh(drive * x2[i]);
+    }
+
+    float* y = saturated.data();
+    stage1Down.downsample(x2, y);
+
+    for (int lane = 0; lane < numLanes; ++lane)
+        frame[lane] += (y[lane] - frame[lane]) * fadeGain;
+}
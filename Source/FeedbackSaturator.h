@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Polyphase half-band FIR for one 2x resampling step of any number of lanes.
+//
+// Every other tap of a half-band filter is zero except the centre one, so the
+// upsampler only needs the even taps for one output phase and a plain delay for
+// the other, and the downsampler works the same way in reverse. A frame -- one
+// sample per lane -- is stored in one piece, so the convolution is a loop over
+// the lanes per tap that vectorizes, whether the lanes are a stereo pair or the
+// channels of many streams.
+class HalfBandStage
+{
+public:
+    // numTaps = 4 * order - 1, the latency is (2 * order - 1) / 2 samples at the lower rate
+    explicit HalfBandStage(int order);
+
+    // not on the audio thread -- allocates the history, also resets
+    void setNumLanes(int numLanes);
+
+    void reset() noexcept;
+
+    // one frame in at the low rate, two frames out one after the other
+    void upsample(const float* in, float* out) noexcept;
+
+    // two frames in at the high rate one after the other, one frame out
+    void downsample(const float* in, float* out) noexcept;
+
+    float getLatency() const noexcept { return float(2 * order - 1) * 0.5f; }
+
+    // bytes of taps, history and scratch
+    size_t getMemoryUsage() const noexcept {
+        return (coefficients.capacity() + evenHistory.capacity() + oddHistory.capacity() + sums.capacity()) * sizeof(float);
+    }
+
+private:
+    void push(std::vector<float>& history, int& pos, int length, const float* frame) noexcept;
+    void convolve(const float* history, float* out) noexcept;
+
+    int order;
+    int numLanes;
+    std::vector<float> coefficients; // the even taps
+
+    // frames newest first, stored twice so the window is always contiguous
+    std::vector<float> evenHistory;
+    std::vector<float> oddHistory;
+    int evenPos;
+    int oddPos;
+
+    std::vector<float> sums; // per lane, odd taps summed apart from the even ones
+};
+
+// Drive stage inside the feedback loop, run at 2x or 4x the sample rate so the
+// harmonics it adds don't fold back into the repeats. At 1x it's bypassed and
+// costs nothing. Processes a frame of any number of lanes, they all share the
+// drive and the oversampling.
+class FeedbackSaturator
+{
+public:
+    FeedbackSaturator();
+
+    // not on the audio thread -- allocates the stages for numLanes, sets the length
+    // of the crossfade when the oversampling changes
+    void prepare(double sampleRate, int numLanes);
+
+    // switches to the last setOversampling() right away
+    void reset() noexcept;
+
+    // factor is 1 (bypassed), 2 or 4, switching doesn't allocate. The output fades
+    // over to the clean signal, the filters are flushed and it fades back in.
+    void setOversampling(int factor) noexcept;
+    void setDrive(float gain) noexcept { drive = gain; }
+
+    // latency in samples at the host rate, subtract it from the delay to keep the loop length
+    float getLatency() const noexcept;
+
+    // an oversampling change is still on its way, getLatency() will change along with it
+    bool isSwitching() const noexcept { return factor != targetFactor; }
+
+    // bytes held by the four half-band stages and the scratch frames
+    size_t getMemoryUsage() const noexcept;
+
+    // in place, one sample per lane
+    void process(float* frame) noexcept;
+
+private:
+    void resetStages() noexcept;
+
+    HalfBandStage stage1Up, stage1Down; // 1x <-> 2x
+    HalfBandStage stage2Up, stage2Down; // 2x <-> 4x, shorter since the transition band is wider
+
+    int numLanes;
+    std::vector<float> up2; // two frames at 2x
+    std::vector<float> up4; // four frames at 4x
+    std::vector<float> saturated;
+
+    int factor; // what's running now
+    int targetFactor; // what was asked for, taken over once fadeGain is down to 0
+    float fadeGain; // 0 is the clean signal, 1 the saturated one
+    float fadeStep;
+    float drive;
+};
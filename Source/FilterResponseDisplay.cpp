@@ -0,0 +1,181 @@
+#include "FilterResponseDisplay.h"
+#include "Parameters.h"
+#include "LookAndFeel.h"
+
+FilterResponseDisplay::FilterResponseDisplay(juce::AudioProcessor& p, juce::AudioProcessorValueTreeState& apvts)
+    : juce::Thread("Filter Response"), processor(p)
+{
+    lowCutValue = apvts.getRawParameterValue(lowCutParamID.getParamID());
+    highCutValue = apvts.getRawParameterValue(highCutParamID.getParamID());
+    feedbackValue = apvts.getRawParameterValue(feedbackParamID.getParamID());
+    rateValue = apvts.getRawParameterValue(rateParamID.getParamID());
+
+    wanted = readParameters();
+    pending = wanted;
+    hasPending = true;
+
+    setInterceptsMouseClicks(false, false);
+
+    startThread(juce::Thread::Priority::low);
+    startTimerHz(30);
+}
+
+FilterResponseDisplay::~FilterResponseDisplay() {
+    stopTimer();
+
+    signalThreadShouldExit();
+    notify();
+    stopThread(1000);
+}
+
+FilterResponseDisplay::Key FilterResponseDisplay::readParameters() const {
+    // the host's rate once the plug-in is prepared, a typical one until then
+    double sampleRate = processor.getSampleRate();
+    if (sampleRate <= 0.0)
+        sampleRate = 48000.0;
+
+    // the filters run at the internal rate, which also moves their nyquist down
+    sampleRate /= double(1 << juce::roundToInt(rateValue->load()));
+
+    Key key;
+    key.lowCut = juce::roundToInt(lowCutValue->load());
+    key.highCut = juce::roundToInt(highCutValue->load());
+    key.feedback = juce::roundToInt(feedbackValue->load());
+    key.sampleRate = juce::roundToInt(sampleRate);
+    return key;
+}
+
+// ======= message thread =======
+void FilterResponseDisplay::timerCallback() {
+    auto key = readParameters();
+
+    if (!(key == wanted)) {
+        wanted = key;
+
+        const juce::ScopedLock sl(lock);
+        if (cache.find(wanted) == cache.end()) {
+            pending = wanted;
+            hasPending = true;
+            notify();
+        }
+    }
+
+    if (hasShown && shown == wanted)
+        return;
+
+    // picks up the curves as soon as the worker has them
+    const juce::ScopedLock sl(lock);
+    auto found = cache.find(wanted);
+    if (found != cache.end()) {
+        curves = found->second;
+        shown = wanted;
+        hasShown = true;
+        repaint();
+    }
+}
+
+void FilterResponseDisplay::paint(juce::Graphics& g) {
+    auto bounds = getLocalBounds().toFloat();
+
+    g.setColour(Colors::Response::background);
+    g.fillRoundedRectangle(bounds, 4.0f);
+
+    auto area = bounds.reduced(4.0f);
+    auto toScreen = juce::AffineTransform::scale(area.getWidth(), area.getHeight())
+                        .translated(area.getX(), area.getY());
+
+    // grid -- 100 Hz, 1 kHz, 10 kHz and every 12 dB
+    g.setColour(Colors::Response::grid);
+    for (float freq : { 100.0f, 1000.0f, 10000.0f }) {
+        float x = std::log(freq / minFreq) / std::log(maxFreq / minFreq);
+        g.drawVerticalLine(juce::roundToInt(area.getX() + x * area.getWidth()), area.getY(), area.getBottom());
+    }
+    for (float db = -12.0f; db > minDecibels; db -= 12.0f) {
+        float y = db / minDecibels;
+        g.drawHorizontalLine(juce::roundToInt(area.getY() + y * area.getHeight()), area.getX(), area.getRight());
+    }
+
+    if (curves == nullptr)
+        return;
+
+    // later repeats fade out
+    for (int i = numRepeats - 1; i >= 0; --i) {
+        g.setColour(Colors::Response::repeat.withMultipliedAlpha(1.0f - float(i) / float(numRepeats)));
+        g.strokePath(curves->repeats[i], juce::PathStrokeType(1.0f), toScreen);
+    }
+
+    g.setColour(Colors::Response::filter);
+    g.strokePath(curves->filter, juce::PathStrokeType(2.0f), toScreen);
+}
+
+// ======= worker thread =======
+void FilterResponseDisplay::run() {
+    while (!threadShouldExit()) {
+        Key key;
+        {
+            const juce::ScopedLock sl(lock);
+            key = pending;
+            if (!hasPending) {
+                const juce::ScopedUnlock sul(lock);
+                wait(-1);
+                continue;
+            }
+            hasPending = false;
+        }
+
+        auto result = calculate(key);
+
+        const juce::ScopedLock sl(lock);
+        if (cache.size() >= maxCacheSize)
+            cache.clear(); // cheap to rebuild, only recently used sets matter
+        cache[key] = result;
+    }
+}
+
+// StateVariableTPTFilter is a bilinear-transformed 2nd order Butterworth at the
+// default resonance, so with W = tan(pi f / fs) / tan(pi fc / fs):
+//   |H_lowpass|^2 = 1 / (1 + W^4)    |H_highpass|^2 = W^4 / (1 + W^4)
+std::shared_ptr<const FilterResponseDisplay::Curves> FilterResponseDisplay::calculate(const Key& key) {
+    auto result = std::make_shared<Curves>();
+
+    double nyquist = key.sampleRate * 0.5;
+    double lowCutWarped = std::tan(juce::MathConstants<double>::pi * juce::jmin(double(key.lowCut), nyquist * 0.98) / key.sampleRate);
+    double highCutWarped = std::tan(juce::MathConstants<double>::pi * juce::jmin(double(key.highCut), nyquist * 0.98) / key.sampleRate);
+    double feedbackDb = 20.0 * std::log10(juce::jmax(std::abs(key.feedback) * 0.01, 1e-6));
+
+    for (int i = 0; i < numPoints; ++i) {
+        float x = float(i) / float(numPoints - 1);
+        double freq = minFreq * std::pow(double(maxFreq / minFreq), double(x));
+
+        double magnitudeDb = -200.0;
+        if (freq < nyquist) {
+            double warped = std::tan(juce::MathConstants<double>::pi * freq / key.sampleRate);
+
+            double wl = warped / lowCutWarped;
+            double wl4 = wl * wl * wl * wl;
+            double highpass = wl4 / (1.0 + wl4);
+
+            double wh = warped / highCutWarped;
+            double wh4 = wh * wh * wh * wh;
+            double lowpass = 1.0 / (1.0 + wh4);
+
+            magnitudeDb = 10.0 * std::log10(juce::jmax(highpass * lowpass, 1e-20));
+        }
+
+        auto toY = [](double db) { return float(juce::jlimit(0.0, 1.0, db / double(minDecibels))); };
+
+        // the filter alone, then the feedback gain and the filters once more on every repeat
+        auto filterPoint = juce::Point<float>(x, toY(magnitudeDb));
+        if (i == 0) result->filter.startNewSubPath(filterPoint);
+        else result->filter.lineTo(filterPoint);
+
+        for (int repeat = 0; repeat < numRepeats; ++repeat) {
+            double repeatDb = double(repeat + 1) * (magnitudeDb + feedbackDb);
+            auto point = juce::Point<float>(x, toY(repeatDb));
+            if (i == 0) result->repeats[repeat].startNewSubPath(point);
+            else result->repeats[repeat].lineTo(point);
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <map>
+#include <memory>
+#include <tuple>
+
+// Shows the combined low-cut/high-cut magnitude of the feedback path and how
+// the repeats decay through it.
+//
+// The curves are computed analytically on a background thread from the
+// parameter values in the APVTS -- never from the filters the audio thread
+// uses -- and cached per parameter set. The message thread only polls the
+// parameters and draws a precomputed path.
+class FilterResponseDisplay : public juce::Component, private juce::Timer, private juce::Thread
+{
+public:
+    FilterResponseDisplay(juce::AudioProcessor& processor, juce::AudioProcessorValueTreeState& apvts);
+    ~FilterResponseDisplay() override;
+
+    void paint(juce::Graphics&) override;
+
+    // ======= constants =======
+    static constexpr int numRepeats = 4;    // decay curves drawn below the filter response
+    static constexpr int numPoints = 256;   // log spaced from minFreq to maxFreq
+    static constexpr float minFreq = 20.0f;
+    static constexpr float maxFreq = 20000.0f;
+    static constexpr float minDecibels = -48.0f; // bottom of the display, top is 0 dB
+
+private:
+    // parameter set a curve was computed for, already rounded to what the knobs can produce
+    struct Key
+    {
+        int lowCut = 0;
+        int highCut = 0;
+        int feedback = 0; // percent
+        int sampleRate = 0;
+
+        bool operator<(const Key& other) const noexcept {
+            return std::tie(lowCut, highCut, feedback, sampleRate)
+                 < std::tie(other.lowCut, other.highCut, other.feedback, other.sampleRate);
+        }
+        bool operator==(const Key& other) const noexcept {
+            return !(*this < other) && !(other < *this);
+        }
+    };
+
+    // paths in normalized coordinates, x and y from 0 to 1, so resizing doesn't invalidate them
+    struct Curves
+    {
+        juce::Path filter;
+        juce::Path repeats[numRepeats];
+    };
+
+    void timerCallback() override;
+    void run() override;
+
+    Key readParameters() const;
+    static std::shared_ptr<const Curves> calculate(const Key& key);
+
+    juce::AudioProcessor& processor;
+    std::atomic<float>* lowCutValue;
+    std::atomic<float>* highCutValue;
+    std::atomic<float>* feedbackValue;
+    std::atomic<float>* rateValue;
+
+    // shared between the message thread and the worker
+    juce::CriticalSection lock;
+    std::map<Key, std::shared_ptr<const Curves>> cache;
+    Key pending;
+    bool hasPending = false;
+
+    // message thread only
+    Key wanted;
+    Key shown;
+    bool hasShown = false;
+    std::shared_ptr<const Curves> curves;
+
+    static constexpr size_t maxCacheSize = 64;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FilterResponseDisplay)
+};
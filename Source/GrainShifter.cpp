@@ -0,0 +1,30 @@
+#include "GrainShifter.h"
+#include "FastMath.h"
+#include "DSP.h"
+
+#include <cmath>
+
+void GrainShifter::prepare(double sampleRate, int numLanes) {
+    // about 40 ms -- short enough to follow the repeats, long enough to keep the low end
+    grainLength = std::max(numGrains, int(sampleRate * 0.04) / numGrains * numGrains);
+
+    window.resize(size_t(grainLength));
+    for (int i = 0; i < grainLength; ++i)
+        window[size_t(i)] = float(0.5 - 0.5 * std::cos(2.0 * PI * double(i) / double(grainLength)));
+
+    grainFrame.resize(size_t(numLanes));
+    reset();
+}
+
+void GrainShifter::reset() noexcept {
+    // evenly spread, so the windows always add up to the same gain
+    for (int i = 0; i < numGrains; ++i) {
+        grains[size_t(i)].age = i * grainLength / numGrains;
+        grains[size_t(i)].slope = ratio - 1.0f;
+        grains[size_t(i)].offset = std::max(grains[size_t(i)].slope, 0.0f) * float(grainLength);
+    }
+}
+
+void GrainShifter::setPitch(float semitones) noexcept {
+    ratio = FastMath::exp2(semitones / 12.0f);
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include "DelayLineBank.h"
+
+// Granular pitch shifter for the shimmer repeats.
+//
+// A fixed pool of grains reads straight out of the delay line at a delay that
+// drifts by (ratio - 1) samples per sample, so no extra history is kept. The
+// grains are spread evenly over one grain length and all of them run on every
+// sample, windowed from a precomputed Hann table -- the cost per sample is the
+// same whatever the pitch. Every grain keeps the ratio it started with, so pitch
+// changes never jump in the middle of a grain. The grains are shared by all lanes
+// of the delay line, only the samples they read differ.
+class GrainShifter
+{
+public:
+    static constexpr int numGrains = 2; // 50% overlap, the Hann windows add up to 1
+
+    // not on the audio thread -- builds the window table
+    void prepare(double sampleRate, int numLanes);
+    void reset() noexcept;
+
+    // extra history the grains read past the base delay, the delay line needs room for it
+    int getHeadroom() const noexcept { return grainLength; }
+
+    // bytes of the window table and the scratch frame
+    size_t getMemoryUsage() const noexcept { return (window.capacity() + grainFrame.capacity()) * sizeof(float); }
+
+    // picked up by each grain when it starts over
+    void setPitch(float semitones) noexcept;
+
+    // every lane of all grains around baseDelay into frame, the delay line is left as it was
+    void process(const DelayLineBank& delayLine, float baseDelay, float* frame) noexcept {
+        const int numLanes = delayLine.getNumLanes();
+        std::fill(frame, frame + numLanes, 0.0f);
+
+        for (auto& grain : grains) {
+            if (grain.age == 0) {
+                grain.slope = ratio - 1.0f;
+                grain.offset = std::max(grain.slope, 0.0f) * float(grainLength);
+            }
+
+            float delay = baseDelay + grain.offset - grain.slope * float(grain.age);
+            float gain = window[size_t(grain.age)];
+
+            delayLine.read(delay, grainFrame.data());
+            for (int lane = 0; lane < numLanes; ++lane)
+                frame[lane] += gain * grainFrame[size_t(lane)];
+
+            if (++grain.age == grainLength)
+                grain.age = 0;
+        }
+    }
+
+private:
+    struct Grain
+    {
+        int age = 0;         // samples since the grain started
+        float slope = 0.0f;  // ratio - 1, fixed for the life of the grain
+        float offset = 0.0f; // pitching up starts further back so it never reads ahead of baseDelay
+    };
+
+    std::array<Grain, numGrains> grains;
+    std::vector<float> window; // Hann, one grain long
+    std::vector<float> grainFrame; // what one grain reads, one sample per lane
+    int grainLength = 1;
+    float ratio = 1.0f;
+};
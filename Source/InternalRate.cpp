@@ -0,0 +1,98 @@
+#include "InternalRate.h"
+
+#include <algorithm>
+
+InternalRateConverter::InternalRateConverter()
+    : sharpDown(8), shortDown(4), sharpUp(8), shortUp(4)
+{
+    // a stereo pair
+    sharpDown.setNumLanes(2);
+    shortDown.setNumLanes(2);
+    sharpUp.setNumLanes(2);
+    shortUp.setNumLanes(2);
+
+    factor = 2;
+    reset();
+}
+
+void InternalRateConverter::setFactor(int newFactor) noexcept {
+    newFactor = newFactor > 2 ? 4 : 2;
+    if (newFactor != factor) {
+        factor = newFactor;
+        reset();
+    }
+}
+
+void InternalRateConverter::reset() noexcept {
+    sharpDown.reset();
+    shortDown.reset();
+    sharpUp.reset();
+    shortUp.reset();
+
+    std::fill(inputFrames, inputFrames + 8, 0.0f);
+    std::fill(outputFrames, outputFrames + 8, 0.0f);
+    inputCount = 0;
+    outputPos = 0;
+}
+
+bool InternalRateConverter::pushInput(float left, float right, float& outLeft, float& outRight) noexcept {
+    inputFrames[2 * inputCount] = left;
+    inputFrames[2 * inputCount + 1] = right;
+
+    if (++inputCount < factor)
+        return false;
+
+    inputCount = 0;
+
+    float decimated[2];
+    if (factor == 4) {
+        float half[4]; // L R L R at half the host rate
+        shortDown.downsample(inputFrames, half);
+        shortDown.downsample(inputFrames + 4, half + 2);
+        sharpDown.downsample(half, decimated);
+    }
+    else {
+        sharpDown.downsample(inputFrames, decimated);
+    }
+
+    outLeft = decimated[0];
+    outRight = decimated[1];
+    return true;
+}
+
+void InternalRateConverter::pushOutput(float left, float right) noexcept {
+    float frame[2] = { left, right };
+
+    if (factor == 4) {
+        float half[4];
+        sharpUp.upsample(frame, half);
+        shortUp.upsample(half, outputFrames);
+        shortUp.upsample(half + 2, outputFrames + 4);
+    }
+    else {
+        sharpUp.upsample(frame, outputFrames);
+    }
+
+    outputPos = 0;
+}
+
+void InternalRateConverter::popOutput(float& left, float& right) noexcept {
+    left = outputFrames[2 * outputPos];
+    right = outputFrames[2 * outputPos + 1];
+    outputPos = std::min(outputPos + 1, factor - 1);
+}
+
+size_t InternalRateConverter::getMemoryUsage() const noexcept {
+    return sharpDown.getMemoryUsage() + shortDown.getMemoryUsage()
+         + sharpUp.getMemoryUsage() + shortUp.getMemoryUsage();
+}
+
+float InternalRateConverter::getLatency() const noexcept {
+    // half-band stages in internal samples, the short ones count half at the host/2 rate
+    float latency = sharpDown.getLatency() + sharpUp.getLatency();
+    if (factor == 4)
+        latency += (shortDown.getLatency() + shortUp.getLatency()) * 0.5f;
+
+    // plus waiting for a full group of input frames and handing the output out one by one
+    return latency * float(factor) + float(factor);
+}
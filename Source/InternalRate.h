@@ -0,0 +1,50 @@
+#pragma once
+
+#include "FeedbackSaturator.h" // HalfBandStage
+
+// Takes the wet path down to 1/2 or 1/4 of the host rate and back up.
+//
+// The input is low-passed and decimated with the same polyphase half-band
+// stages as the feedback drive, so the delay line, the feedback loop and
+// everything in it run once per `factor` host samples. On the way out every
+// internal frame is interpolated back to `factor` host frames, which are handed
+// out one per host sample until the next internal frame arrives.
+//
+// For 1/4 the steep half-band runs at the lower of the two rates, where it sets
+// the passband edge; the stage at the host rate only has to keep what would
+// fold into that passband out, so it can be short.
+class InternalRateConverter
+{
+public:
+    InternalRateConverter();
+
+    // 2 or 4 -- 1 is handled by not using the converter at all
+    void setFactor(int newFactor) noexcept;
+    int getFactor() const noexcept { return factor; }
+
+    void reset() noexcept;
+
+    // one host frame in, true when that completed an internal frame
+    bool pushInput(float left, float right, float& outLeft, float& outRight) noexcept;
+
+    // one internal frame in, comes out over the next `factor` calls to popOutput()
+    void pushOutput(float left, float right) noexcept;
+    void popOutput(float& left, float& right) noexcept;
+
+    // from pushInput() to popOutput() in host samples, the wet path arrives this much later
+    float getLatency() const noexcept;
+
+    // bytes held by the half-band stages, the frame buffers are part of the object
+    size_t getMemoryUsage() const noexcept;
+
+private:
+    HalfBandStage sharpDown, shortDown; // at the internal rate, at half the host rate
+    HalfBandStage sharpUp, shortUp;
+
+    int factor;
+
+    float inputFrames[8];  // interleaved, up to 4 host frames
+    float outputFrames[8];
+    int inputCount;
+    int outputPos;
+};
@@ -0,0 +1,207 @@
+#include "LongDelayLine.h"
+
+LongDelayLine::LongDelayLine()
+    : juce::Thread("Long Delay Prefetch")
+{
+    recentFrames = 0;
+    windowFrames = 0;
+    fileData = nullptr;
+    fileFrames = 0;
+    writeIndex = 0;
+    clearedIndex = 0;
+}
+
+LongDelayLine::~LongDelayLine() {
+    release();
+}
+
+int LongDelayLine::nextPowerOfTwo(double numFrames) {
+    return juce::nextPowerOfTwo(int(std::ceil(numFrames)));
+}
+
+void LongDelayLine::prepare(double sampleRate, float maxDelayInMilliseconds) {
+    release();
+
+    recentFrames = nextPowerOfTwo(recentSeconds * sampleRate);
+    windowFrames = nextPowerOfTwo(windowSeconds * sampleRate);
+    recent.assign(size_t(recentFrames * 2), 0.0f);
+    window.assign(size_t(windowFrames * 2), 0.0f);
+
+    // the file holds the full history plus some slack for the rings
+    fileFrames = juce::int64(std::ceil(maxDelayInMilliseconds / 1000.0 * sampleRate)) + recentFrames + windowFrames;
+    auto numBytes = fileFrames * 2 * juce::int64(sizeof(float));
+
+    tempFile = std::make_unique<juce::TemporaryFile>(".delay");
+    {
+        // grows the file to its full size, most file systems keep it sparse
+        juce::FileOutputStream stream(tempFile->getFile());
+        if (stream.openedOk()) {
+            stream.setPosition(numBytes - 1);
+            stream.writeByte(0);
+        }
+    }
+
+    mappedFile = std::make_unique<juce::MemoryMappedFile>(tempFile->getFile(), juce::MemoryMappedFile::readWrite);
+    if (mappedFile->getData() == nullptr || juce::int64(mappedFile->getSize()) < numBytes) {
+        jassertfalse; // couldn't map the temp file, long mode stays off
+        release();
+        return;
+    }
+    fileData = static_cast<float*>(mappedFile->getData());
+
+    reset();
+
+    startThread(juce::Thread::Priority::low);
+    ready.store(true, std::memory_order_release);
+}
+
+void LongDelayLine::release() {
+    ready.store(false, std::memory_order_release);
+    stopThread(1000);
+
+    // unmap before the temp file deletes itself
+    fileData = nullptr;
+    mappedFile.reset();
+    tempFile.reset();
+
+    recent.clear();
+    recent.shrink_to_fit();
+    window.clear();
+    window.shrink_to_fit();
+}
+
+// called by prepare() -- possibly from the timer while the audio thread is running,
+// but before the line is marked ready, and the audio thread only touches the line
+// once isReady() returns true. The prefetch thread isn't started yet either
+void LongDelayLine::reset() noexcept {
+    std::fill(recent.begin(), recent.end(), 0.0f);
+    std::fill(window.begin(), window.end(), 0.0f);
+
+    writeIndex = 0;
+    clearedIndex = 0;
+    written.store(0);
+    flushed.store(0);
+    readIndex.store(0);
+    windowStart.store(0);
+    windowEnd.store(0);
+}
+
+// ======= audio thread =======
+void LongDelayLine::readFrame(juce::int64 index, float& left, float& right) const noexcept {
+    left = 0.0f;
+    right = 0.0f;
+
+    if (index < clearedIndex)
+        return;
+
+    if (writeIndex - index <= recentFrames) {
+        auto slot = size_t(index & (recentFrames - 1)) * 2;
+        left = recent[slot];
+        right = recent[slot + 1];
+    }
+    else if (isInWindow(index)) {
+        auto slot = size_t(index & (windowFrames - 1)) * 2;
+        float l = window[slot];
+        float r = window[slot + 1];
+
+        // seqlock style -- the prefetch thread moves windowStart past a frame before it
+        // overwrites its slot, so a frame that's still in the window after the read wasn't
+        // touched in the meantime; otherwise it's treated like a frame that isn't there yet
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (isInWindow(index)) {
+            left = l;
+            right = r;
+        }
+    }
+    // otherwise the prefetch thread hasn't caught up yet (e.g. right after a
+    // big jump in delay time) and the repeat is silent for a moment
+}
+
+void LongDelayLine::read(float delayInSamples, float* frame) noexcept {
+    double position = double(writeIndex) - double(juce::jmax(1.0f, delayInSamples));
+    auto index = juce::int64(std::floor(position));
+    float fraction = float(position - double(index));
+
+    readIndex.store(index, std::memory_order_release);
+
+    // linear interpolation between the two neighbouring frames
+    float l0, r0, l1, r1;
+    readFrame(index, l0, r0);
+    readFrame(index + 1, l1, r1);
+
+    frame[0] = l0 + (l1 - l0) * fraction;
+    frame[1] = r0 + (r1 - r0) * fraction;
+}
+
+void LongDelayLine::push(const float* frame) noexcept {
+    auto slot = size_t(writeIndex & (recentFrames - 1)) * 2;
+    recent[slot] = frame[0];
+    recent[slot + 1] = frame[1];
+
+    ++writeIndex;
+    written.store(writeIndex, std::memory_order_release);
+}
+
+// ======= prefetch thread =======
+void LongDelayLine::run() {
+    while (!threadShouldExit()) {
+        flushToFile();
+        prefetchWindow();
+        wait(5);
+    }
+}
+
+void LongDelayLine::flushToFile() {
+    auto from = flushed.load(std::memory_order_relaxed);
+    auto to = written.load(std::memory_order_acquire);
+
+    // fell behind by more than the recent ring, the oldest frames are already gone
+    from = juce::jmax(from, to - recentFrames);
+
+    for (auto index = from; index < to; ++index) {
+        auto src = size_t(index & (recentFrames - 1)) * 2;
+        auto dest = size_t(index % fileFrames) * 2;
+        fileData[dest] = recent[src];
+        fileData[dest + 1] = recent[src + 1];
+    }
+
+    flushed.store(to, std::memory_order_release);
+}
+
+void LongDelayLine::prefetchWindow() {
+    auto target = readIndex.load(std::memory_order_acquire);
+    auto available = flushed.load(std::memory_order_acquire);
+    auto start = windowStart.load(std::memory_order_relaxed);
+    auto end = windowEnd.load(std::memory_order_relaxed);
+
+    auto lookBehind = windowFrames / 4; // keeps room for the interpolation and small modulation
+    auto desiredStart = juce::jmax(juce::int64(0), target - lookBehind);
+
+    // the read head jumped out of the window -- start over from the new position
+    if (target < start || target > end + windowFrames / 2) {
+        windowStart.store(std::numeric_limits<juce::int64>::max(), std::memory_order_release);
+        windowEnd.store(desiredStart, std::memory_order_release);
+        windowStart.store(desiredStart, std::memory_order_release);
+        start = desiredStart;
+        end = desiredStart;
+    }
+
+    auto newEnd = juce::jmin(desiredStart + windowFrames, available);
+    if (newEnd <= end)
+        return;
+
+    // gives up the slots that are about to be overwritten before touching them,
+    // the fence keeps the writes below from moving ahead of the new start
+    auto newStart = juce::jmax(start, newEnd - windowFrames);
+    windowStart.store(newStart, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (auto index = juce::jmax(end, newStart); index < newEnd; ++index) {
+        auto src = size_t(index % fileFrames) * 2;
+        auto dest = size_t(index & (windowFrames - 1)) * 2;
+        window[dest] = fileData[src];
+        window[dest + 1] = fileData[src + 1];
+    }
+
+    windowEnd.store(newEnd, std::memory_order_release);
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <atomic>
+#include <vector>
+
+#include "DelayEngine.h" // ExternalDelayLine
+
+// Stereo delay line for delays of several minutes.
+//
+// Only the last few seconds live in RAM (the "recent" ring written by the audio
+// thread). A background thread copies that history into a memory-mapped temp
+// file and prefetches the region around the read head back into a second RAM
+// ring (the "window"). The audio thread only ever touches the two RAM rings, so
+// it never page-faults on the mapped file. One stereo pair, the DelayEngine
+// reads and writes it in place of its own line.
+class LongDelayLine : public ExternalDelayLine, private juce::Thread
+{
+public:
+    LongDelayLine();
+    ~LongDelayLine() override;
+
+    // not on the audio thread -- allocates the rings and the temp file, starts the prefetch thread
+    void prepare(double sampleRate, float maxDelayInMilliseconds);
+    void release();
+
+    bool isReady() const noexcept { return ready.load(std::memory_order_acquire); }
+
+    // not on the audio thread -- bytes of RAM held by the rings, the temp file isn't counted
+    size_t getMemoryUsage() const noexcept { return (recent.capacity() + window.capacity()) * sizeof(float); }
+    void reset() noexcept;
+
+    // audio thread, only once isReady() -- everything pushed so far reads back as silence, nothing gets zeroed
+    void clear() noexcept override { clearedIndex = writeIndex; }
+
+    // audio thread -- read before push, delayInSamples >= 1, frames are L R
+    void read(float delayInSamples, float* frame) noexcept override;
+    void push(const float* frame) noexcept override;
+
+    // ======= constants =======
+    static constexpr double recentSeconds = 4.0; // history that never leaves RAM
+    static constexpr double windowSeconds = 4.0; // prefetched history around the read head
+
+private:
+    void run() override;
+    void flushToFile();
+    void prefetchWindow();
+
+    void readFrame(juce::int64 index, float& left, float& right) const noexcept;
+
+    bool isInWindow(juce::int64 index) const noexcept {
+        return index >= windowStart.load(std::memory_order_acquire)
+            && index < windowEnd.load(std::memory_order_acquire);
+    }
+
+    static int nextPowerOfTwo(double numFrames);
+
+    // interleaved stereo frames
+    std::vector<float> recent;
+    std::vector<float> window;
+    juce::int64 recentFrames;
+    juce::int64 windowFrames;
+
+    std::unique_ptr<juce::TemporaryFile> tempFile;
+    std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+    float* fileData; // only touched by the prefetch thread
+    juce::int64 fileFrames;
+
+    juce::int64 writeIndex; // audio thread's own copy of "written"
+    juce::int64 clearedIndex; // frames before this one are silent, set by clear()
+
+    // absolute frame indices shared between the audio and the prefetch thread
+    std::atomic<juce::int64> written{ 0 };     // frames pushed by the audio thread
+    std::atomic<juce::int64> flushed{ 0 };     // frames copied to the file
+    std::atomic<juce::int64> readIndex{ 0 };   // oldest frame the audio thread is reading
+    std::atomic<juce::int64> windowStart{ 0 }; // [windowStart, windowEnd) is valid in the window
+    std::atomic<juce::int64> windowEnd{ 0 };
+    std::atomic<bool> ready{ false };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LongDelayLine)
+};
@@ -1,16 +1,26 @@
 #include "LookAndFeel.h"
 
-// for adding new fonts to plugin -- loads font from the font file (in asset project directory)
-const juce::Typeface::Ptr Fonts::typeface = juce::Typeface::createSystemTypefaceFor(
-	BinaryData::LatoMedium_ttf, BinaryData::LatoMedium_ttfSize);
+// ========== EditorResources ==========
+EditorResources::EditorResources()
+	// for adding new fonts to plugin -- loads font from the font file (in asset project directory),
+	// before the look and feel below that gets handed the typeface
+	: typeface(juce::Typeface::createSystemTypefaceFor(BinaryData::LatoMedium_ttf, BinaryData::LatoMedium_ttfSize)),
+	  rotaryKnobLookAndFeel(typeface)
+{
+	// decoded here instead of through juce::ImageCache so they go away with the last editor
+	noise = juce::ImageFileFormat::loadFrom(BinaryData::Noise_png, BinaryData::Noise_pngSize);
+	logo = juce::ImageFileFormat::loadFrom(BinaryData::Logo_png, BinaryData::Logo_pngSize);
+}
 
 // ========== Fonts ==========
-juce::Font Fonts::getFont(float height) {
+juce::Font Fonts::getFont(const juce::Typeface::Ptr& typeface, float height) {
 	return juce::Font(typeface).withHeight(height);
 }
 
 // ========== RotaryKnobLookAndFeel ==========
-RotaryKnobLookAndFeel::RotaryKnobLookAndFeel() {
+RotaryKnobLookAndFeel::RotaryKnobLookAndFeel(juce::Typeface::Ptr labelTypeface) {
+	typeface = labelTypeface;
+
 	setColour(juce::Label::textColourId, Colors::Knob::label);
 	setColour(juce::Slider::textBoxTextColourId, Colors::Knob::label);
 	setColour(juce::Slider::rotarySliderFillColourId, Colors::Knob::trackActive);
@@ -92,7 +102,7 @@ void RotaryKnobLookAndFeel::drawRotarySlider(juce::Graphics& g,
 }
 
 juce::Font RotaryKnobLookAndFeel::getLabelFont([[maybe_used]] juce::Label&) {
-	return Fonts::getFont();
+	return Fonts::getFont(typeface);
 }
 
 juce::Label* RotaryKnobLookAndFeel::createSliderTextBox(juce::Slider& slider) {
@@ -116,7 +126,7 @@ MainLookAndFeel::MainLookAndFeel() {
 }
 
 juce::Font MainLookAndFeel::getLabelFont([[maybe_unused]] juce::Label& label) {
-	return Fonts::getFont();
+	return Fonts::getFont(resources->typeface);
 }
 
 // ========== RotaryKnobLabel ==========
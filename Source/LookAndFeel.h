@@ -28,6 +28,14 @@ namespace Colors
         const juce::Colour label{ 160, 155, 150 };
         const juce::Colour outline{ 235, 230, 225 };
     }
+
+    namespace Response
+    {
+        const juce::Colour background{ 80, 80, 80 };
+        const juce::Colour grid{ 105, 105, 105 };
+        const juce::Colour filter{ 177, 101, 135 };
+        const juce::Colour repeat{ 205, 200, 195 };
+    }
 }
 
 // ========== Fonts ==========
@@ -36,17 +44,15 @@ class Fonts
 public:
     Fonts() = delete; // means you don't/can't create an instance of this class to use the function
     
-    static juce::Font getFont(float height = 16.0f);
-
-private:
-    static const juce::Typeface::Ptr typeface;
+    // the typeface lives in EditorResources, the look and feels keep hold of it
+    static juce::Font getFont(const juce::Typeface::Ptr& typeface, float height = 16.0f);
 };
 
 // ========== RotaryKnobLookAndFeel ==========
 class RotaryKnobLookAndFeel : public juce::LookAndFeel_V4
 {
 public:
-    RotaryKnobLookAndFeel();
+    explicit RotaryKnobLookAndFeel(juce::Typeface::Ptr typeface);
 
     juce::Label* createSliderTextBox(juce::Slider&) override;
 
@@ -59,13 +65,9 @@ public:
     // ====== getters/setters ======
     juce::Font getLabelFont(juce::Label& slider) override;
 
-    static RotaryKnobLookAndFeel* get() {
-        static RotaryKnobLookAndFeel instance;
-        return &instance;
-    }
-
 private:
     juce::DropShadow dropShadow{ Colors::Knob::dropShadow, 6, { 0, 3 } };
+    juce::Typeface::Ptr typeface; // from EditorResources, which owns this look and feel too
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RotaryKnobLookAndFeel)
 };
@@ -81,6 +83,26 @@ public:
     juce::TextEditor* createEditorComponent() override;
 };
 
+// ========== EditorResources ==========
+// GUI-only assets. Nothing here is touched at library load or by a headless
+// instance -- they're created when the first editor opens, shared by all
+// editors in the process and released when the last one closes.
+// Hold a juce::SharedResourcePointer<EditorResources> to keep them alive.
+class EditorResources
+{
+public:
+    EditorResources();
+
+    juce::Typeface::Ptr typeface;
+    juce::Image noise;
+    juce::Image logo;
+
+    RotaryKnobLookAndFeel rotaryKnobLookAndFeel;
+
+private:
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EditorResources)
+};
+
 // ========== MainLookAndFeel ==========
 class MainLookAndFeel : public juce::LookAndFeel_V4
 {
@@ -90,5 +112,8 @@ public:
     juce::Font getLabelFont(juce::Label&) override;
 
 private:
+    // keeps the typeface alive -- taken once here, not on every getLabelFont() call
+    juce::SharedResourcePointer<EditorResources> resources;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MainLookAndFeel)
 };
@@ -2,14 +2,6 @@
 #include "Utilities.h"
 #include "DSP.h"
 
-template<typename T>
-static void Parameters::castParameter(juce::AudioProcessorValueTreeState& apvts, 
-                            const juce::ParameterID& id, T& destination) 
-{
-    destination = dynamic_cast<T>(apvts.getParameter(id.getParamID()));
-    jassert(destination); // parameter does not exist or wrong type
-}
-
 Parameters::Parameters(juce::AudioProcessorValueTreeState& apvts) {
     // initialize variables
     gain = 0.0f;
@@ -20,144 +12,151 @@ Parameters::Parameters(juce::AudioProcessorValueTreeState& apvts) {
     panR = 1.0f;
     lowCut = 20.0f;
     highCut = 20000.0f;
-
-    targetDelayTime = 0.0f;
-    coeff = 0.0f;
-
-    // grabbing parameter from apvts
-    castParameter(apvts, gainParamID, gainParam);
-    castParameter(apvts, delayTimeParamID, delayTimeParam);
-    castParameter(apvts, mixParamID, mixParam);
-    castParameter(apvts, feedbackParamID, feedbackParam);
-    castParameter(apvts, stereoParamID, stereoParam);
-    castParameter(apvts, lowCutParamID, lowCutParam);
-    castParameter(apvts, highCutParamID, highCutParam);
+    longMode = false;
+    longDelayTime = 0.0f;
+    drive = 1.0f;
+    driveOn = false;
+    oversampling = 2;
+    character = 0;
+    shimmer = 0.0f;
+    pitch = 12.0f;
+
+    // grabbing the parameter values from apvts
+    for (int i = 0; i < numParams; ++i) {
+        rawValues[i] = apvts.getRawParameterValue(paramTable[i].id);
+        jassert(rawValues[i]); // parameter does not exist
+        snapshot[i] = 0.0f;
+    }
 }
 
-// adds the given parameter to the juce framework
+// adds every row of the parameter table to the juce framework
 juce::AudioProcessorValueTreeState::ParameterLayout Parameters::createParameterLayout() {
     juce::AudioProcessorValueTreeState::ParameterLayout layout;
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        gainParamID,
-        "Output Gain",
-        juce::NormalisableRange<float> { -12.0f, 12.0f },
-        0.0f,
-        juce::AudioParameterFloatAttributes().withStringFromValueFunction(stringFromDecibels)
-    ));
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        delayTimeParamID,
-        "Delay Time",
-        juce::NormalisableRange<float> { minDelayTime, maxDelayTime, 0.001f, 0.25f },
-        100.0f,
-        juce::AudioParameterFloatAttributes()
-        .withStringFromValueFunction(stringFromMilliseconds)
-        .withValueFromStringFunction(millisecondsFromString)
-    ));
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        mixParamID,
-        "Mix",
-        juce::NormalisableRange<float>(0.0f, 100.0f, 1.0f),
-        100.0f,
-        juce::AudioParameterFloatAttributes().withStringFromValueFunction(stringFromPercent)
-    ));
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        feedbackParamID,
-        "Feedback",
-        juce::NormalisableRange<float>(-100.0f, 100.0f, 1.0f),
-        0.0f,
-        juce::AudioParameterFloatAttributes().withStringFromValueFunction(stringFromPercent)
-    ));
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        stereoParamID,
-        "Stereo",
-        juce::NormalisableRange<float>(-100.0f, 100.0f, 1.0f),
-        0.0f,
-        juce::AudioParameterFloatAttributes().withStringFromValueFunction(stringFromPercent)
-    ));
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        lowCutParamID,
-        "Low Cut",
-        juce::NormalisableRange<float>(20.0f, 20000.0f, 1.0f, 0.3f),
-        20.0f,
-        juce::AudioParameterFloatAttributes()
-        .withStringFromValueFunction(stringFromHz)
-        .withValueFromStringFunction(hzFromString)
-    ));
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        highCutParamID,
-        "High Cut",
-        juce::NormalisableRange<float>(20.0f, 20000.0f, 1.0f, 0.3f),
-        20000.0f,
-        juce::AudioParameterFloatAttributes()
-        .withStringFromValueFunction(stringFromHz)
-        .withValueFromStringFunction(hzFromString)
-    ));
+    for (const auto& row : paramTable) {
+        juce::ParameterID id{ row.id, 1 };
+
+        if (row.kind == ParamKind::toggle) {
+            layout.add(std::make_unique<juce::AudioParameterBool>(id, row.name, row.defaultValue >= 0.5f));
+            continue;
+        }
+
+        if (row.kind == ParamKind::choice) {
+            juce::StringArray choices;
+            for (int i = 0; i < row.numChoices; ++i)
+                choices.add(row.choices[i]);
+
+            layout.add(std::make_unique<juce::AudioParameterChoice>(id, row.name, choices, int(row.defaultValue)));
+            continue;
+        }
+
+        auto attributes = juce::AudioParameterFloatAttributes();
+        switch (row.unit) {
+            case ParamUnit::milliseconds:
+                attributes = attributes.withStringFromValueFunction(makeCachedFormatter(formatMilliseconds))
+                                       .withValueFromStringFunction(millisecondsFromString);
+                break;
+            case ParamUnit::decibels:
+                attributes = attributes.withStringFromValueFunction(makeCachedFormatter(formatDecibels));
+                break;
+            case ParamUnit::percent:
+                attributes = attributes.withStringFromValueFunction(makeCachedFormatter(formatPercent));
+                break;
+            case ParamUnit::hz:
+                attributes = attributes.withStringFromValueFunction(makeCachedFormatter(formatHz))
+                                       .withValueFromStringFunction(hzFromString);
+                break;
+            case ParamUnit::semitones:
+                attributes = attributes.withStringFromValueFunction(makeCachedFormatter(formatSemitones));
+                break;
+            case ParamUnit::none:
+                break;
+        }
+
+        layout.add(std::make_unique<juce::AudioParameterFloat>(
+            id,
+            row.name,
+            juce::NormalisableRange<float> { row.min, row.max, row.step, row.skew },
+            row.defaultValue,
+            attributes
+        ));
+    }
 
     return layout;
 }
 
 void Parameters::prepareToPlay(double sampleRate) noexcept {
-    double duration = 0.02;
-    feedbackSmoother.reset(sampleRate, duration);
-    
-    coeff = 1.0f - std::exp(-1.0f / (0.2f * float(sampleRate))); // exponential smoothing -- 200 ms
-
-    gainSmoother.reset(sampleRate, duration);
-    mixSmoother.reset(sampleRate, duration);
-    stereoSmoother.reset(sampleRate, duration);
-    lowCutSmoother.reset(sampleRate, duration);
-    highCutSmoother.reset(sampleRate, duration);
+    for (const auto& row : paramTable) {
+        if (row.smoothing == ParamSmoothing::none)
+            continue;
+
+        auto kind = row.smoothing == ParamSmoothing::linear ? SmootherBank::Kind::linear : SmootherBank::Kind::exponential;
+        smoothers.setup(ParamTable::smootherLane(row.index), kind, sampleRate, row.smoothingTime);
+    }
 }
 
-void Parameters::reset() noexcept {
-    gain = 0.0f;
-    delayTime = 0.0f;
-    mix = 1.0f;
-    feedback = 0.0f;
-    panL = 0.0f;
-    panR = 1.0f;
-    lowCut = 20.0f;
-    highCut = 20000.0f;
+// reads every parameter once and converts it to what the DSP works with
+void Parameters::takeSnapshot() noexcept {
+    for (int i = 0; i < numParams; ++i) {
+        float value = rawValues[i]->load(std::memory_order_relaxed);
+
+        switch (paramTable[i].convert) {
+            case ParamConvert::percent: value *= 0.01f; break; // converts 100% to 1 and 0% to 0.0 for example
+            case ParamConvert::decibels: value = FastMath::decibelsToGain(value); break;
+            case ParamConvert::none: break;
+        }
 
-    gainSmoother.setCurrentAndTargetValue(juce::Decibels::decibelsToGain(gainParam->get()));
-    mixSmoother.setCurrentAndTargetValue(mixParam->get() * 0.01f); // converts 100% to 1 and 0% to 0.0 for example
-    feedbackSmoother.setCurrentAndTargetValue(feedbackParam->get() * 0.01f);
-    stereoSmoother.setCurrentAndTargetValue(stereoParam->get() * 0.01f);
-    lowCutSmoother.setCurrentAndTargetValue(stereoParam->get());
-    highCutSmoother.setCurrentAndTargetValue(stereoParam->get());
+        snapshot[i] = value;
+    }
 }
 
-void Parameters::update() noexcept {
-    gainSmoother.setTargetValue(juce::Decibels::decibelsToGain(gainParam->get()));
+void Parameters::readUnsmoothed() noexcept {
+    longMode = snapshot[longModeIndex] >= 0.5f;
+    longDelayTime = snapshot[longTimeIndex];
+    driveOn = snapshot[driveIndex] > 1.001f; // 0 dB, with some room for the fast exp2
+    oversampling = snapshot[qualityIndex] < 0.5f ? 2 : 4;
+    character = juce::roundToInt(snapshot[characterIndex]);
+    pitch = snapshot[pitchIndex];
+}
+
+void Parameters::readSmoothers() noexcept {
+    gain = smoothed<gainIndex>();
+    delayTime = smoothed<delayTimeIndex>();
+    mix = smoothed<mixIndex>();
+    feedback = smoothed<feedbackIndex>();
 
-    targetDelayTime = delayTimeParam->get();
-    if (delayTime == 0.0f)
-        delayTime = targetDelayTime;
+    panningEqualPower(smoothed<stereoIndex>(), panL, panR);
 
-    mixSmoother.setTargetValue(mixParam->get() * 0.01f);
-    feedbackSmoother.setTargetValue(mixParam->get() * 0.01f);
-    stereoSmoother.setTargetValue(stereoParam->get() * 0.01f);
-    lowCutSmoother.setTargetValue(stereoParam->get());
-    highCutSmoother.setTargetValue(stereoParam->get());
+    lowCut = smoothed<lowCutIndex>();
+    highCut = smoothed<highCutIndex>();
+    drive = smoothed<driveIndex>();
+    shimmer = smoothed<shimmerIndex>();
 }
 
-void Parameters::smoothen() noexcept {
-    gain = gainSmoother.getNextValue();
+// jumps straight to the current parameter values
+void Parameters::reset() noexcept {
+    takeSnapshot();
+
+    for (const auto& row : paramTable)
+        if (row.smoothing != ParamSmoothing::none)
+            smoothers.setCurrentAndTarget(ParamTable::smootherLane(row.index), snapshot[row.index]);
 
-    delayTime += (targetDelayTime - delayTime) * coeff;
+    readUnsmoothed();
+    readSmoothers();
+}
+
+void Parameters::update() noexcept {
+    takeSnapshot();
 
-    mix = mixSmoother.getNextValue();
-    feedback = feedbackSmoother.getNextValue();
+    for (const auto& row : paramTable)
+        if (row.smoothing != ParamSmoothing::none)
+            smoothers.setTarget(ParamTable::smootherLane(row.index), snapshot[row.index]);
 
-    panningEqualPower(stereoSmoother.getNextValue(), panL, panR);
+    readUnsmoothed();
+}
 
-    lowCut = lowCutSmoother.getNextValue();
-    highCut = highCutSmoother.getNextValue();
-}
\ No newline at end of file
+// advances every smoother in one step of the bank
+void Parameters::smoothen() noexcept {
+    smoothers.next();
+    readSmoothers();
+}
@@ -2,13 +2,122 @@
 
 #include <JuceHeader.h> // can use namespace juce::
 
-const juce::ParameterID gainParamID{ "gain", 1 };
-const juce::ParameterID delayTimeParamID{ "delayTime", 1 };
-const juce::ParameterID mixParamID{ "mix", 1 };
-const juce::ParameterID feedbackParamID{ "feedback", 1 };
-const juce::ParameterID stereoParamID{ "stereo", 1 };
-const juce::ParameterID lowCutParamID{ "lowCut", 1 };
-const juce::ParameterID highCutParamID{ "highCut", 1 };
+#include <type_traits>
+
+#include "SmootherBank.h"
+
+// ======= parameter table =======
+// every parameter is described once below -- the layout, the smoother lanes and the
+// per-block snapshot are generated from the table, so nothing has to be wired by hand
+
+enum ParamIndex
+{
+	gainIndex, delayTimeIndex, mixIndex, feedbackIndex, stereoIndex, lowCutIndex, highCutIndex,
+	longModeIndex, longTimeIndex, driveIndex, qualityIndex, characterIndex,
+	shimmerIndex, pitchIndex, rateIndex,
+	numParams
+};
+
+enum class ParamKind { floating, toggle, choice };
+enum class ParamUnit { none, milliseconds, decibels, percent, hz, semitones }; // picks the text functions
+enum class ParamConvert { none, percent, decibels }; // raw value -> value used by the DSP, 50% -> 0.5, dB -> gain
+enum class ParamSmoothing { none, linear, exponential };
+
+struct ParamDescriptor
+{
+	ParamIndex index; // has to match the row, checked below
+	const char* id;
+	const char* name;
+	ParamKind kind;
+	float min, max, step, skew;
+	float defaultValue; // 0/1 for toggles, the item index for choices
+	ParamUnit unit;
+	ParamConvert convert;
+	ParamSmoothing smoothing;
+	float smoothingTime; // seconds
+	const char* const* choices = nullptr;
+	int numChoices = 0;
+};
+
+inline constexpr const char* qualityChoices[] = { "Normal", "High" }; // 2x and 4x oversampling of the feedback drive
+inline constexpr const char* characterChoices[] = { "Off", "Tape", "Speaker", "Spring" }; // impulse response in the feedback loop
+inline constexpr const char* rateChoices[] = { "Full", "1/2", "1/4" }; // the wet path runs at host rate / 2^index
+
+namespace ParamLimits
+{
+	inline constexpr float minDelayTime = 5.0f;
+	inline constexpr float maxDelayTime = 5000.0f;
+	inline constexpr float maxLongDelayTime = 600000.0f; // 10 minutes in long-delay mode
+	inline constexpr float maxDrive = 24.0f;
+}
+
+inline constexpr ParamDescriptor paramTable[numParams] = {
+	// index, id, name, kind, min, max, step, skew, default, unit, convert, smoothing, smoothing time
+	{ gainIndex,      "gain",      "Output Gain", ParamKind::floating, -12.0f,                    12.0f,                         0.0f,   1.0f,  0.0f,     ParamUnit::decibels,     ParamConvert::decibels, ParamSmoothing::linear,      0.02f },
+	{ delayTimeIndex, "delayTime", "Delay Time",  ParamKind::floating, ParamLimits::minDelayTime, ParamLimits::maxDelayTime,     0.001f, 0.25f, 100.0f,   ParamUnit::milliseconds, ParamConvert::none,     ParamSmoothing::exponential, 0.2f },
+	{ mixIndex,       "mix",       "Mix",         ParamKind::floating, 0.0f,                      100.0f,                        1.0f,   1.0f,  100.0f,   ParamUnit::percent,      ParamConvert::percent,  ParamSmoothing::linear,      0.02f },
+	{ feedbackIndex,  "feedback",  "Feedback",    ParamKind::floating, -100.0f,                   100.0f,                        1.0f,   1.0f,  0.0f,     ParamUnit::percent,      ParamConvert::percent,  ParamSmoothing::linear,      0.02f },
+	{ stereoIndex,    "stereo",    "Stereo",      ParamKind::floating, -100.0f,                   100.0f,                        1.0f,   1.0f,  0.0f,     ParamUnit::percent,      ParamConvert::percent,  ParamSmoothing::linear,      0.02f },
+	{ lowCutIndex,    "lowCut",    "Low Cut",     ParamKind::floating, 20.0f,                     20000.0f,                      1.0f,   0.3f,  20.0f,    ParamUnit::hz,           ParamConvert::none,     ParamSmoothing::linear,      0.02f },
+	{ highCutIndex,   "highCut",   "High Cut",    ParamKind::floating, 20.0f,                     20000.0f,                      1.0f,   0.3f,  20000.0f, ParamUnit::hz,           ParamConvert::none,     ParamSmoothing::linear,      0.02f },
+	{ longModeIndex,  "longMode",  "Long Delay",  ParamKind::toggle,   0.0f,                      1.0f,                          1.0f,   1.0f,  0.0f,     ParamUnit::none,         ParamConvert::none,     ParamSmoothing::none,        0.0f },
+	// no smoothing, gliding over minutes would sweep the pitch for ages
+	{ longTimeIndex,  "longTime",  "Long Time",   ParamKind::floating, ParamLimits::maxDelayTime, ParamLimits::maxLongDelayTime, 1.0f,   0.3f,  30000.0f, ParamUnit::milliseconds, ParamConvert::none,     ParamSmoothing::none,        0.0f },
+	{ driveIndex,     "drive",     "Drive",       ParamKind::floating, 0.0f,                      ParamLimits::maxDrive,         0.1f,   1.0f,  0.0f,     ParamUnit::decibels,     ParamConvert::decibels, ParamSmoothing::linear,      0.02f },
+	{ qualityIndex,   "quality",   "Quality",     ParamKind::choice,   0.0f,                      1.0f,                          1.0f,   1.0f,  0.0f,     ParamUnit::none,         ParamConvert::none,     ParamSmoothing::none,        0.0f, qualityChoices, 2 },
+	{ characterIndex, "character", "Character",   ParamKind::choice,   0.0f,                      3.0f,                          1.0f,   1.0f,  0.0f,     ParamUnit::none,         ParamConvert::none,     ParamSmoothing::none,        0.0f, characterChoices, 4 },
+	{ shimmerIndex,   "shimmer",   "Shimmer",     ParamKind::floating, 0.0f,                      100.0f,                        1.0f,   1.0f,  0.0f,     ParamUnit::percent,      ParamConvert::percent,  ParamSmoothing::linear,      0.02f },
+	// no smoothing, every grain holds on to the pitch it started with
+	{ pitchIndex,     "pitch",     "Pitch",       ParamKind::floating, -12.0f,                    12.0f,                         1.0f,   1.0f,  12.0f,    ParamUnit::semitones,    ParamConvert::none,     ParamSmoothing::none,        0.0f },
+	// no smoothing, switching re-allocates the wet path from the processor's timer
+	{ rateIndex,      "rate",      "Internal Rate", ParamKind::choice, 0.0f,                    2.0f,                          1.0f,   1.0f,  0.0f,     ParamUnit::none,         ParamConvert::none,     ParamSmoothing::none,        0.0f, rateChoices, 3 },
+};
+
+namespace ParamTable
+{
+	constexpr bool isInOrder() {
+		for (int i = 0; i < numParams; ++i)
+			if (paramTable[i].index != i)
+				return false;
+		return true;
+	}
+
+	// smoothed parameters get consecutive lanes of the smoother bank in table order
+	constexpr int smootherLane(int index) {
+		int lane = 0;
+		for (int i = 0; i < index; ++i)
+			if (paramTable[i].smoothing != ParamSmoothing::none)
+				++lane;
+		return lane;
+	}
+
+	constexpr int numSmoothed() { return smootherLane(numParams); }
+}
+
+static_assert(ParamTable::isInOrder(), "paramTable rows have to be in ParamIndex order");
+static_assert(ParamTable::numSmoothed() <= SmootherBank::numLanes, "more smoothed parameters than smoother lanes");
+
+// the juce parameter class that goes with a row
+template<ParamIndex index>
+using ParamType = std::conditional_t<paramTable[index].kind == ParamKind::toggle, juce::AudioParameterBool,
+                  std::conditional_t<paramTable[index].kind == ParamKind::choice, juce::AudioParameterChoice,
+                                     juce::AudioParameterFloat>>;
+
+const juce::ParameterID gainParamID{ paramTable[gainIndex].id, 1 };
+const juce::ParameterID delayTimeParamID{ paramTable[delayTimeIndex].id, 1 };
+const juce::ParameterID mixParamID{ paramTable[mixIndex].id, 1 };
+const juce::ParameterID feedbackParamID{ paramTable[feedbackIndex].id, 1 };
+const juce::ParameterID stereoParamID{ paramTable[stereoIndex].id, 1 };
+const juce::ParameterID lowCutParamID{ paramTable[lowCutIndex].id, 1 };
+const juce::ParameterID highCutParamID{ paramTable[highCutIndex].id, 1 };
+const juce::ParameterID longModeParamID{ paramTable[longModeIndex].id, 1 };
+const juce::ParameterID longTimeParamID{ paramTable[longTimeIndex].id, 1 };
+const juce::ParameterID driveParamID{ paramTable[driveIndex].id, 1 };
+const juce::ParameterID qualityParamID{ paramTable[qualityIndex].id, 1 };
+const juce::ParameterID characterParamID{ paramTable[characterIndex].id, 1 };
+const juce::ParameterID shimmerParamID{ paramTable[shimmerIndex].id, 1 };
+const juce::ParameterID pitchParamID{ paramTable[pitchIndex].id, 1 };
+const juce::ParameterID rateParamID{ paramTable[rateIndex].id, 1 };
 
 class Parameters
 {
@@ -16,21 +125,29 @@ public:
 	Parameters(juce::AudioProcessorValueTreeState& apvts);
 
 	static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
-	
+
 	void prepareToPlay(double sampleRate) noexcept;
 	void reset() noexcept;
-	void update() noexcept; // triggers on every block
+	void update() noexcept; // once per slice of up to 64 frames, see DelayAudioProcessor::subBlockSize
 	void smoothen() noexcept;
+	bool isSettled() const noexcept { return smoothers.isSettled(); } // nothing will change until the next update()
 
 	// ======= helper functions =======
-	template<typename T>
-	static void castParameter(juce::AudioProcessorValueTreeState& apvts, const juce::ParameterID& id, T& destination);
+	// typed pointer to a parameter, e.g. getParameter<qualityIndex>(apvts)->choices
+	template<ParamIndex index>
+	static ParamType<index>* getParameter(juce::AudioProcessorValueTreeState& apvts) {
+		auto* parameter = dynamic_cast<ParamType<index>*>(apvts.getParameter(paramTable[index].id));
+		jassert(parameter); // parameter does not exist or wrong type
+		return parameter;
+	}
 
 	// ======= constants =======
-	static constexpr float minDelayTime = 5.0f;
-	static constexpr float maxDelayTime = 5000.0f;
+	static constexpr float minDelayTime = ParamLimits::minDelayTime;
+	static constexpr float maxDelayTime = ParamLimits::maxDelayTime;
+	static constexpr float maxLongDelayTime = ParamLimits::maxLongDelayTime;
 	static constexpr float minOutputGain = -36.0f;
 	static constexpr float maxOutputGain = 12.0f;
+	static constexpr float maxDrive = ParamLimits::maxDrive;
 
 	// ======= variables =======
 	float gain;
@@ -41,25 +158,32 @@ public:
 	float panR;
 	float lowCut;
 	float highCut;
+	bool longMode;
+	float longDelayTime;
+	float drive; // linear gain into the feedback saturation
+	bool driveOn; // above 0 dB, the saturator is bypassed otherwise
+	int oversampling; // 2x or 4x, follows the quality setting
+	int character; // FeedbackConvolver::Character, 0 is off
+	float shimmer; // 0-1, how much of the feedback goes through the pitch shifter
+	float pitch; // semitones
 
 private:
-	float targetDelayTime; // value that the one-pole filter is trying to reach
-	float coeff; // one-pole smoothing -- how fast the smoothing happens
-
-	juce::AudioParameterFloat* gainParam;
-	juce::AudioParameterFloat* mixParam;
-	juce::AudioParameterFloat* feedbackParam;
-	juce::AudioParameterFloat* stereoParam;
-	juce::AudioParameterFloat* lowCutParam;
-	juce::AudioParameterFloat* highCutParam;
-
-	juce::AudioParameterFloat* delayTimeParam;
-
-	// smoothing helps prevent audio clicks
-	juce::LinearSmoothedValue<float> gainSmoother; 
-	juce::LinearSmoothedValue<float> mixSmoother;
-	juce::LinearSmoothedValue<float> feedbackSmoother;
-	juce::LinearSmoothedValue<float> stereoSmoother;
-	juce::LinearSmoothedValue<float> lowCutSmoother;
-	juce::LinearSmoothedValue<float> highCutSmoother;
+	void takeSnapshot() noexcept;
+	void readSmoothers() noexcept;
+	void readUnsmoothed() noexcept;
+
+	template<ParamIndex index>
+	float smoothed() const noexcept {
+		static_assert(paramTable[index].smoothing != ParamSmoothing::none, "parameter isn't smoothed");
+		return smoothers.get(ParamTable::smootherLane(index));
+	}
+
+	// the atomics behind every parameter, read directly instead of through the virtual get()
+	std::atomic<float>* rawValues[numParams];
+
+	// every value converted for the DSP, taken once per update()
+	alignas(32) float snapshot[numParams];
+
+	// smoothing helps prevent audio clicks -- linear ramps plus a one-pole for the delay time
+	SmootherBank smoothers;
 };
@@ -8,6 +8,8 @@ DelayAudioProcessorEditor::DelayAudioProcessorEditor (DelayAudioProcessor& p)
     delayGroup.setText("Delay");
     delayGroup.setTextLabelPosition(juce::Justification::horizontallyCentred);
     delayGroup.addAndMakeVisible(delayTimeKnob); // adding delayTime to group
+    delayGroup.addAndMakeVisible(longTimeKnob);
+    delayGroup.addAndMakeVisible(longModeButton);
     addAndMakeVisible(delayGroup);
 
     feedbackGroup.setText("Feedback");
@@ -16,6 +18,28 @@ DelayAudioProcessorEditor::DelayAudioProcessorEditor (DelayAudioProcessor& p)
     feedbackGroup.addAndMakeVisible(stereoKnob);
     feedbackGroup.addAndMakeVisible(lowCutKnob);
     feedbackGroup.addAndMakeVisible(highCutKnob);
+    feedbackGroup.addAndMakeVisible(driveKnob);
+    feedbackGroup.addAndMakeVisible(shimmerKnob);
+    feedbackGroup.addAndMakeVisible(pitchKnob);
+
+    auto* quality = Parameters::getParameter<qualityIndex>(audioProcessor.apvts);
+    qualityBox.addItemList(quality->choices, 1);
+    qualityAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        audioProcessor.apvts, qualityParamID.getParamID(), qualityBox);
+    feedbackGroup.addAndMakeVisible(qualityBox);
+
+    auto* character = Parameters::getParameter<characterIndex>(audioProcessor.apvts);
+    characterBox.addItemList(character->choices, 1);
+    characterAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        audioProcessor.apvts, characterParamID.getParamID(), characterBox);
+    feedbackGroup.addAndMakeVisible(characterBox);
+
+    auto* rate = Parameters::getParameter<rateIndex>(audioProcessor.apvts);
+    rateBox.addItemList(rate->choices, 1);
+    rateAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        audioProcessor.apvts, rateParamID.getParamID(), rateBox);
+    feedbackGroup.addAndMakeVisible(rateBox);
+    feedbackGroup.addAndMakeVisible(responseDisplay);
     addAndMakeVisible(feedbackGroup);
 
     outputGroup.setText("Output");
@@ -24,10 +48,23 @@ DelayAudioProcessorEditor::DelayAudioProcessorEditor (DelayAudioProcessor& p)
     outputGroup.addAndMakeVisible(mixKnob);
     addAndMakeVisible(outputGroup);
 
+    clearButton.onClick = [this] { audioProcessor.sendCommand(DelayCommand::clear); };
+    addAndMakeVisible(clearButton);
+
+    freezeButton.setClickingTogglesState(true);
+    freezeButton.setToggleState(audioProcessor.isFrozen(), juce::dontSendNotification);
+    freezeButton.onClick = [this] {
+        audioProcessor.sendCommand(freezeButton.getToggleState() ? DelayCommand::freeze : DelayCommand::unfreeze);
+    };
+    addAndMakeVisible(freezeButton);
+
+    tapButton.onClick = [this] { audioProcessor.sendCommand(DelayCommand::tap); };
+    addAndMakeVisible(tapButton);
+
     // changing color
     //gainKnob.slider.setColour(juce::Slider::rotarySliderFillColourId, juce::Colours::green);
 
-    setSize (500, 330);
+    setSize (870, 360);
 
     setLookAndFeel(&mainLF);
 }
@@ -38,8 +75,7 @@ DelayAudioProcessorEditor::~DelayAudioProcessorEditor() {
 
 void DelayAudioProcessorEditor::paint (juce::Graphics& g) {
     // adding texture to UI
-    auto noise = juce::ImageCache::getFromMemory(BinaryData::Noise_png, BinaryData::Noise_pngSize);
-    auto fillType = juce::FillType(noise, juce::AffineTransform::scale(0.5f));
+    auto fillType = juce::FillType(resources->noise, juce::AffineTransform::scale(0.5f));
     g.setFillType(fillType);
     g.fillRect(getLocalBounds());
 
@@ -48,7 +84,7 @@ void DelayAudioProcessorEditor::paint (juce::Graphics& g) {
     g.setColour(Colors::header);
     g.fillRect(rect);
 
-    auto image = juce::ImageCache::getFromMemory(BinaryData::Logo_png, BinaryData::Logo_pngSize);
+    const auto& image = resources->logo;
 
     int destWidth = image.getWidth() / 2;
     int destHeight = image.getHeight() / 2;
@@ -63,6 +99,11 @@ void DelayAudioProcessorEditor::resized() {
     int y = 50; // y position
     int height = bounds.getHeight() - 60;
 
+    // actions in the banner, right side
+    tapButton.setBounds(bounds.getWidth() - 70, 8, 60, 24);
+    freezeButton.setBounds(tapButton.getX() - 70, 8, 60, 24);
+    clearButton.setBounds(freezeButton.getX() - 70, 8, 60, 24);
+
     // Position the groups
     delayGroup.setBounds(10, y, 110, height);
     outputGroup.setBounds(bounds.getWidth() - 160, y, 150, height);
@@ -70,10 +111,20 @@ void DelayAudioProcessorEditor::resized() {
 
     // position the knobs inside the groups
     delayTimeKnob.setTopLeftPosition(20, 20); // relative to the top left of the UI group created
+    longTimeKnob.setTopLeftPosition(delayTimeKnob.getX(), delayTimeKnob.getBottom() + 10);
+    longModeButton.setBounds(longTimeKnob.getX(), longTimeKnob.getBottom() + 5, 70, 24);
     mixKnob.setTopLeftPosition(20, 20); // relative to the top left of the UI group created
     gainKnob.setTopLeftPosition(mixKnob.getX(), mixKnob.getBottom() + 10); // relative to the top left of the UI group created
     feedbackKnob.setTopLeftPosition(20, 20); // relative to the top left of the UI group created
     stereoKnob.setTopLeftPosition(feedbackKnob.getRight() + 20, 20);
     lowCutKnob.setTopLeftPosition(feedbackKnob.getX(), feedbackKnob.getBottom() + 10);
     highCutKnob.setTopLeftPosition(lowCutKnob.getRight() + 20, lowCutKnob.getY());
+    driveKnob.setTopLeftPosition(stereoKnob.getRight() + 20, 20);
+    qualityBox.setBounds(driveKnob.getX(), highCutKnob.getY() + 24, 70, 24);
+    characterBox.setBounds(qualityBox.getX(), qualityBox.getBottom() + 10, 70, 24);
+    rateBox.setBounds(characterBox.getX(), characterBox.getBottom() + 10, 70, 24);
+    shimmerKnob.setTopLeftPosition(driveKnob.getRight() + 20, 20);
+    pitchKnob.setTopLeftPosition(shimmerKnob.getX(), shimmerKnob.getBottom() + 10);
+    responseDisplay.setBounds(shimmerKnob.getRight() + 20, 30,
+                              feedbackGroup.getWidth() - shimmerKnob.getRight() - 40, feedbackGroup.getHeight() - 50);
 }
\ No newline at end of file
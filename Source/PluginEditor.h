@@ -6,6 +6,7 @@
 #include "Parameters.h"
 #include "RotaryKnob.h"
 #include "LookAndFeel.h"
+#include "FilterResponseDisplay.h"
 
 class DelayAudioProcessorEditor  : public juce::AudioProcessorEditor
 {
@@ -18,6 +19,7 @@ public:
 
 private:
     DelayAudioProcessor& audioProcessor; // reference to processor object
+    juce::SharedResourcePointer<EditorResources> resources; // fonts and images, shared by all open editors
     MainLookAndFeel mainLF;
 
     // this connects the UI sliders to the backend parameters in the apvts
@@ -28,6 +30,30 @@ private:
     RotaryKnob stereoKnob{ "Stereo", audioProcessor.apvts, stereoParamID, true };
     RotaryKnob lowCutKnob{ "Low Cut", audioProcessor.apvts, lowCutParamID };
     RotaryKnob highCutKnob{ "High Cut", audioProcessor.apvts, highCutParamID };
+    RotaryKnob longTimeKnob{ "Long Time", audioProcessor.apvts, longTimeParamID };
+    RotaryKnob driveKnob{ "Drive", audioProcessor.apvts, driveParamID };
+    RotaryKnob shimmerKnob{ "Shimmer", audioProcessor.apvts, shimmerParamID };
+    RotaryKnob pitchKnob{ "Pitch", audioProcessor.apvts, pitchParamID, true };
+
+    juce::ToggleButton longModeButton{ "Long" };
+    juce::AudioProcessorValueTreeState::ButtonAttachment longModeAttachment{
+        audioProcessor.apvts, longModeParamID.getParamID(), longModeButton
+    };
+
+    // items have to be in the box before the attachment is made, see constructor
+    juce::ComboBox qualityBox;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> qualityAttachment;
+    juce::ComboBox characterBox;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> characterAttachment;
+    juce::ComboBox rateBox;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> rateAttachment;
+
+    // one-shot actions, sent through the processor's command queue
+    juce::TextButton clearButton{ "Clear" };
+    juce::TextButton freezeButton{ "Freeze" };
+    juce::TextButton tapButton{ "Tap" };
+
+    FilterResponseDisplay responseDisplay{ audioProcessor, audioProcessor.apvts };
 
     // UI group for the knobs
     juce::GroupComponent delayGroup, feedbackGroup, outputGroup;
@@ -1,6 +1,7 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 #include "ProtectYourEars.h"
+#include "RealtimeCheck.h"
 
 DelayAudioProcessor::DelayAudioProcessor()
      : AudioProcessor (
@@ -10,20 +11,130 @@ DelayAudioProcessor::DelayAudioProcessor()
     params(apvts)
 {
     // init vars
-    feedbackL = 0.0f;
-    feedbackR = 0.0f;
+    rateFactor = 1;
+    loopLatency = 0.0f;
 
-    // -1.0f is off or a special value
-    lastLowCut = -1.0f;
-    lastHighCut = -1.0f;
+    loadedCharacter = FeedbackConvolver::off;
+    loadedSampleRate = 0.0;
 
-    // init filters -- opposite than expected types
-    lowCutFilter.setType(juce::dsp::StateVariableTPTFilterType::highpass);
-    highCutFilter.setType(juce::dsp::StateVariableTPTFilterType::lowpass);
+    lastBlockTime = 0.0;
+    samplePosition = 0;
+    lastTap = -1;
+    tapIntervals.fill(0);
+    numTapIntervals = 0;
+
+    startTimerHz(10); // watches for long mode, the character and tap tempo on the message thread
 }
 
-DelayAudioProcessor::~DelayAudioProcessor()
-{ }
+DelayAudioProcessor::~DelayAudioProcessor() {
+    stopTimer();
+}
+
+// the long delay line and the convolution kernels allocate here, never on the audio thread
+void DelayAudioProcessor::timerCallback() {
+    // nothing gets allocated outside prepareToPlay .. releaseResources
+    double sampleRate = getSampleRate();
+    if (sampleRate <= 0.0 || !prepared.load())
+        return;
+
+    // a new internal rate re-sizes the delay lines, the host gets silence from us in the meantime
+    int factor = 1 << juce::roundToInt(apvts.getRawParameterValue(rateParamID.getParamID())->load());
+    if (factor != rateFactor) {
+        suspendProcessing(true);
+        prepareWetPath(sampleRate, factor);
+        suspendProcessing(false);
+    }
+
+    double internalRate = sampleRate / double(rateFactor);
+
+    auto* longMode = apvts.getRawParameterValue(longModeParamID.getParamID());
+    if (longMode->load() >= 0.5f) {
+        if (!longDelayLine.isReady())
+            longDelayLine.prepare(internalRate, Parameters::maxLongDelayTime);
+    }
+    else if (longDelayLine.isReady()) {
+        // switched off -- a slice may still be reading it, so it's freed like the
+        // internal rate is switched, while the host isn't calling processBlock
+        suspendProcessing(true);
+        longDelayLine.release();
+        suspendProcessing(false);
+    }
+
+    engine.releaseRetired();
+
+    // tap tempo is measured on the audio thread, the parameter is only ever set from here
+    float tapped = tappedDelayTime.exchange(-1.0f);
+    if (tapped > 0.0f) {
+        auto* delayTime = Parameters::getParameter<delayTimeIndex>(apvts);
+        delayTime->beginChangeGesture();
+        delayTime->setValueNotifyingHost(delayTime->convertTo0to1(tapped));
+        delayTime->endChangeGesture();
+    }
+
+    // builds the impulse response for the chosen character, off keeps the last one around
+    int character = juce::roundToInt(apvts.getRawParameterValue(characterParamID.getParamID())->load());
+    if (character != FeedbackConvolver::off && (character != loadedCharacter || internalRate != loadedSampleRate)) {
+        engine.setImpulseResponse(FeedbackConvolver::makeImpulseResponse(FeedbackConvolver::Character(character), internalRate));
+        loadedCharacter = character;
+        loadedSampleRate = internalRate;
+    }
+}
+
+size_t DelayAudioProcessor::getWetPathMemoryUsage() const noexcept {
+    return engine.getMemoryUsage() + longDelayLine.getMemoryUsage() + rateConverter.getMemoryUsage();
+}
+
+void DelayAudioProcessor::sendCommand(DelayCommand::Type type) {
+    commands.push({ type, juce::Time::getMillisecondCounterHiRes() });
+}
+
+void DelayAudioProcessor::applyCommand(const DelayCommand& command, juce::int64 position) noexcept {
+    switch (command.type) {
+        case DelayCommand::clear:
+            // kills every repeat at once -- both delay lines mark their contents as silent
+            // instead of zeroing them, the rest is small enough to reset right away
+            engine.clear();
+            if (longDelayLine.isReady()) // otherwise the timer may be inside prepare() resetting it
+                longDelayLine.clear();
+            break;
+
+        case DelayCommand::freeze:
+        case DelayCommand::unfreeze:
+        {
+            bool frozen = command.type == DelayCommand::freeze;
+            engine.setFrozen(frozen);
+            frozenState.store(frozen, std::memory_order_relaxed);
+            break;
+        }
+
+        case DelayCommand::tap:
+        {
+            double sampleRate = getSampleRate();
+            auto interval = position - lastTap;
+            lastTap = position;
+
+            // a pause longer than the longest delay starts a new series of taps
+            if (interval <= 0 || double(interval) > Parameters::maxDelayTime * 0.001 * sampleRate) {
+                numTapIntervals = 0;
+                break;
+            }
+
+            // the newest intervals, oldest one drops out
+            for (size_t i = tapIntervals.size() - 1; i > 0; --i)
+                tapIntervals[i] = tapIntervals[i - 1];
+            tapIntervals[0] = interval;
+            numTapIntervals = std::min(numTapIntervals + 1, int(tapIntervals.size()));
+
+            juce::int64 sum = 0;
+            for (int i = 0; i < numTapIntervals; ++i)
+                sum += tapIntervals[size_t(i)];
+
+            double milliseconds = double(sum) / double(numTapIntervals) / sampleRate * 1000.0;
+            tappedDelayTime.store(float(juce::jlimit(double(Parameters::minDelayTime), double(Parameters::maxDelayTime), milliseconds)));
+            break;
+        }
+    }
+}
 
 const juce::String DelayAudioProcessor::getName() const {
     return JucePlugin_Name;
@@ -80,38 +191,52 @@ void DelayAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
     params.prepareToPlay(sampleRate);
     params.reset();
 
-    juce::dsp::ProcessSpec spec;
-    spec.sampleRate = sampleRate;
-    spec.maximumBlockSize = juce::uint32(samplesPerBlock);
-    spec.numChannels = 2;
+    int factor = 1 << juce::roundToInt(apvts.getRawParameterValue(rateParamID.getParamID())->load());
+    prepareWetPath(sampleRate, factor);
 
-    delayLine.prepare(spec);
+    lastBlockTime = 0.0;
+    samplePosition = 0;
+    lastTap = -1;
+    numTapIntervals = 0;
 
-    double numSamples = Parameters::maxDelayTime / 1000.0f * sampleRate;
-    // number of samples must be twice as large to prevent the plugin from crashing
-    int maxDelayInSamples = int(std::ceil(numSamples));
-    delayLine.setMaximumDelayInSamples(maxDelayInSamples);
-    delayLine.reset();
+    prepared.store(true);
+}
+
+// everything that depends on the internal rate -- allocates, so never on the audio thread
+void DelayAudioProcessor::prepareWetPath(double sampleRate, int factor) {
+    rateFactor = factor;
+    if (factor > 1)
+        rateConverter.setFactor(factor);
+    rateConverter.reset();
+
+    // rateConverter's latency in internal samples -- the wet output is read this much
+    // ahead of the feedback tap so the repeats still arrive on time, 0 at the full rate
+    engine.setWetTapOffset(factor > 1 ? rateConverter.getLatency() / float(factor) : 0.0f);
 
-    //DBG(maxDelayInSamples);
+    double internalRate = sampleRate / double(factor);
 
-    // resets feedback
-    feedbackL = 0.0f;
-    feedbackR = 0.0f;
-    
-    lowCutFilter.prepare(spec);
-    highCutFilter.prepare(spec);
-    
-    lowCutFilter.reset();
-    highCutFilter.reset();
+    // a lower internal rate needs proportionally less memory for the same delay time
+    double numSamples = Parameters::maxDelayTime / 1000.0f * internalRate;
+    int maxDelayInSamples = int(std::ceil(numSamples));
+
+    // at 0 dB drive the saturator is bypassed, it starts out at the right factor
+    engine.setOversampling(params.driveOn ? params.oversampling : 1);
+    engine.prepare(internalRate, 1, maxDelayInSamples);
+    loopLatency = engine.getLatency();
 
-    lastLowCut = -1.0f;
-    lastHighCut = -1.0f;
+    // only pays for the long delay line when it's actually in use
+    if (apvts.getRawParameterValue(longModeParamID.getParamID())->load() >= 0.5f)
+        longDelayLine.prepare(internalRate, Parameters::maxLongDelayTime);
+    else
+        longDelayLine.release();
 }
 
 void DelayAudioProcessor::releaseResources() {
-    // When playback stops, you can use this as an opportunity to free up any
-    // spare memory, etc.
+    // the timer stops preparing things from here on
+    prepared.store(false);
+
+    // frees the temp file and the RAM windows of the long delay line
+    longDelayLine.release();
 }
 
 bool DelayAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const {
@@ -129,6 +254,7 @@ bool DelayAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) co
 }
 
 void DelayAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages) {
+    ScopedRealtimeCheck realtimeCheck; // no allocations or locks below -- only active in test builds
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
@@ -137,8 +263,6 @@ void DelayAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-    params.update();
-
     // delay line current delay calculations
     float sampleRate = float(getSampleRate());
 
@@ -153,23 +277,85 @@ void DelayAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::
     auto isMainOutputStereo = mainOutputChannels > 1;
     float* outputDataL = mainOutput.getWritePointer(channel::right);
     float* outputDataR = mainOutput.getWritePointer(isMainOutputStereo ? channel::left : channel::right);
-    
-    for (int sample = 0; sample < buffer.getNumSamples(); ++sample) {
-        params.smoothen();
 
-        float delayInSamples = params.delayTime / 1000.0f * sampleRate;
-        delayLine.setDelay(delayInSamples);
+    int numSamples = buffer.getNumSamples();
 
-        // new value changes only if last value changes
-        if (params.lowCut != lastLowCut) {
-            lowCutFilter.setCutoffFrequency(params.lowCut);
-            lastLowCut = params.lowCut;
+    // commands sent during the previous block land at the same distance into this one,
+    // so they're one block late but keep their spacing -- which is what tap tempo needs
+    double blockTime = juce::Time::getMillisecondCounterHiRes();
+    int numPending = 0;
+    DelayCommand command;
+    while (numPending < int(pending.size()) && commands.pop(command)) {
+        double offset = lastBlockTime > 0.0 ? (command.time - lastBlockTime) * 0.001 * sampleRate : 0.0;
+        pending[size_t(numPending++)] = { command, juce::jlimit(0, numSamples - 1, int(offset)) };
+    }
+    lastBlockTime = blockTime;
+
+    // big host blocks (offline bounces) get cut into short slices so the delay line and
+    // filter state touched per slice stay in cache, host blocks up to subBlockSize are one slice;
+    // slices also end where a command has to be applied
+    int nextCommand = 0;
+    for (int offset = 0; offset < numSamples; ) {
+        while (nextCommand < numPending && pending[size_t(nextCommand)].offset <= offset) {
+            applyCommand(pending[size_t(nextCommand)].command, samplePosition + offset);
+            ++nextCommand;
         }
 
-        // new value changes only if last value changes
-        if (params.highCut != lastHighCut) {
-            highCutFilter.setCutoffFrequency(params.highCut);
-            lastHighCut = params.highCut;
+        int end = std::min(offset + subBlockSize, numSamples);
+        if (nextCommand < numPending)
+            end = std::min(end, pending[size_t(nextCommand)].offset);
+
+        processSubBlock(inputDataL + offset, inputDataR + offset,
+                        outputDataL + offset, outputDataR + offset, end - offset, sampleRate);
+        offset = end;
+    }
+
+    samplePosition += numSamples;
+
+    realtimeCheck.end(); // the debug warnings below allocate
+
+    #if JUCE_DEBUG
+        protectYourEars(buffer); // helps with too high of an output gain/volume
+    #endif
+}
+
+void DelayAudioProcessor::processSubBlock(const float* inputDataL, const float* inputDataR,
+                                          float* outputDataL, float* outputDataR,
+                                          int numSamples, float sampleRate) noexcept {
+    // parameter changes are picked up at slice boundaries
+    params.update();
+
+    // everything from the delay line on runs at the internal rate
+    float internalRate = sampleRate / float(rateFactor);
+
+    // at 0 dB drive the saturator is bypassed and adds no latency
+    engine.setOversampling(params.driveOn ? params.oversampling : 1);
+    engine.setPitch(params.pitch);
+    engine.setCharacterOn(params.character != FeedbackConvolver::off);
+
+    // falls back to the regular delay line until the long one is ready
+    bool useLongDelay = params.longMode && longDelayLine.isReady();
+    float longDelayInSamples = params.longDelayTime / 1000.0f * internalRate - loopLatency;
+    engine.setExternalDelayLine(useLongDelay ? &longDelayLine : nullptr, longDelayInSamples);
+
+    // constant parameters for the whole slice -- smoothing and the checks below only run once
+    bool settled = params.isSettled() && !engine.isSwitching() && loopLatency == engine.getLatency();
+    if (settled) {
+        params.smoothen();
+        applySmoothedParameters(internalRate, loopLatency);
+    }
+
+    for (int sample = 0; sample < numSamples; ++sample) {
+        if (!settled) {
+            params.smoothen();
+
+            float saturatorLatency = engine.getLatency(); // in samples, taken off the delay so the loop length stays put
+            if (loopLatency < saturatorLatency)
+                loopLatency = std::min(loopLatency + loopLatencyGlide, saturatorLatency);
+            else if (loopLatency > saturatorLatency)
+                loopLatency = std::max(loopLatency - loopLatencyGlide, saturatorLatency);
+
+            applySmoothedParameters(internalRate, loopLatency);
         }
 
         // reading input samples --  x[n]
@@ -178,26 +364,26 @@ void DelayAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::
 
         float mono = (dryL + dryR) * 0.5f; // convert stereo to mono
 
-        // insert into delay line -- ping pong delay -- z^(-N)
-        delayLine.pushSample(channel::left, mono * params.panL + feedbackR);
-        delayLine.pushSample(channel::right, mono * params.panR + feedbackL);
-
-        float wetL = delayLine.popSample(channel::left);
-        float wetR = delayLine.popSample(channel::right);
-
-        // multi-tap delay
-        //wetL += delayLine.popSample(channel::left, delayInSamples * 2.0f, false) * 0.7f;
-        //wetR += delayLine.popSample(channel::right, delayInSamples * 2.0f, false) * 0.7f;
+        float inputL = mono * params.panL;
+        float inputR = mono * params.panR;
 
-        feedbackL = wetL * params.feedback;
-        // filter left channel
-        feedbackL = lowCutFilter.processSample(channel::left, feedbackL);
-        feedbackL = highCutFilter.processSample(channel::left, feedbackL);
+        float wetL, wetR;
 
-        feedbackR = wetR * params.feedback;
-        // filter left channel
-        feedbackR = lowCutFilter.processSample(channel::right, feedbackR);
-        feedbackR = highCutFilter.processSample(channel::right, feedbackR);
+        if (rateFactor == 1) {
+            engine.process(&inputL, &inputR, &wetL, &wetR);
+        }
+        else {
+            // the loop only runs when a full group of host samples has been decimated,
+            // its output is interpolated back and handed out over the following group
+            rateConverter.popOutput(wetL, wetR);
+
+            float decimatedL, decimatedR;
+            if (rateConverter.pushInput(inputL, inputR, decimatedL, decimatedR)) {
+                float loopWetL, loopWetR;
+                engine.process(&decimatedL, &decimatedR, &loopWetL, &loopWetR);
+                rateConverter.pushOutput(loopWetL, loopWetR);
+            }
+        }
 
         float mixL = dryL + wetL * params.mix;
         float mixR = dryR + wetR * params.mix;
@@ -206,10 +392,19 @@ void DelayAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::
         outputDataL[sample] = mixL * params.gain;
         outputDataR[sample] = mixR * params.gain;
     }
+}
 
-    #if JUCE_DEBUG
-        protectYourEars(buffer); // helps with too high of an output gain/volume
-    #endif
+void DelayAudioProcessor::applySmoothedParameters(float sampleRate, float latency) noexcept {
+    float delayInSamples = params.delayTime / 1000.0f * sampleRate - latency;
+    engine.setDelay(delayInSamples);
+
+    engine.setFeedback(params.feedback);
+    engine.setShimmer(params.shimmer);
+    engine.setDrive(params.drive);
+
+    // only recalculated when they change
+    engine.setLowCut(params.lowCut);
+    engine.setHighCut(params.highCut);
 }
 
 bool DelayAudioProcessor::hasEditor() const {
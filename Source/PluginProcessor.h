@@ -2,11 +2,17 @@
 
 #include <JuceHeader.h>
 
+#include <array>
+
 #include "Parameters.h"
+#include "DelayEngine.h"
+#include "LongDelayLine.h"
+#include "CommandQueue.h"
+#include "InternalRate.h"
 
 enum channel {left, right};
 
-class DelayAudioProcessor  : public juce::AudioProcessor
+class DelayAudioProcessor  : public juce::AudioProcessor, private juce::Timer
 {
 public:
     DelayAudioProcessor();
@@ -46,21 +52,76 @@ public:
         *this, nullptr, "Parameters", Parameters::createParameterLayout() 
     };
 
+    // ====== editor actions ======
+    // message thread -- picked up at the start of the next block, placed where it was sent
+    void sendCommand(DelayCommand::Type type);
+    bool isFrozen() const noexcept { return frozenState.load(std::memory_order_relaxed); }
+
+    // message thread -- bytes held by the wet path's buffers: the delay lines, the
+    // convolver, the saturator, the shifter and the rate converter. The filters keep
+    // a few floats of state and aren't counted, the convolver's kernels aren't either
+    size_t getWetPathMemoryUsage() const noexcept;
+
 private:
+    void timerCallback() override;
+    void processSubBlock(const float* inputDataL, const float* inputDataR,
+                         float* outputDataL, float* outputDataR,
+                         int numSamples, float sampleRate) noexcept;
+    void prepareWetPath(double sampleRate, int factor);
+    void applySmoothedParameters(float sampleRate, float latency) noexcept;
+    void applyCommand(const DelayCommand& command, juce::int64 position) noexcept;
+
+    // longest stretch processed in one go, parameters are updated between slices
+    static constexpr int subBlockSize = 64;
+
     Parameters params;
 
-    // note -- dsp object have state, reset them when needed
-    juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::Linear> delayLine;
+    // the delay lines and everything in the loop run at host rate / rateFactor,
+    // only changed by prepareWetPath() while processing is suspended
+    int rateFactor;
+    InternalRateConverter rateConverter;
+
+    // the feedback loop -- delay line, shimmer, drive, character and filters -- one stream of it
+    DelayEngine engine{ subBlockSize };
+
+    // minutes of delay -- only prepared once long mode gets switched on, the engine
+    // reads it instead of its own delay line while it's ready
+    LongDelayLine longDelayLine;
+
+    // between prepareToPlay and releaseResources, the timer only allocates while it's set
+    std::atomic<bool> prepared{ false };
+
+    // the drive's latency taken off the delay time, follows engine.getLatency()
+    // a little per sample so the read position doesn't jump when the oversampling changes
+    float loopLatency;
+    static constexpr float loopLatencyGlide = 0.01f; // samples per sample, a 1% pitch bend while it moves
+
+    // message thread -- which impulse response the engine was last given
+    int loadedCharacter;
+    double loadedSampleRate;
+
+    // ====== commands ======
+    CommandQueue commands;
+
+    // drained at the start of a block, applied at their offset
+    struct PendingCommand
+    {
+        DelayCommand command;
+        int offset;
+    };
+    std::array<PendingCommand, CommandQueue::capacity> pending;
 
-    // StateVariableTPTFilter can be configured to high, low, or band pass filter
-    juce::dsp::StateVariableTPTFilter<float> lowCutFilter; 
-    juce::dsp::StateVariableTPTFilter<float> highCutFilter;
+    double lastBlockTime; // when the previous block started, commands sent since land in this block
+    juce::int64 samplePosition; // samples processed since prepareToPlay
 
-    float feedbackL;
-    float feedbackR;
+    // freeze -- the loop keeps circulating what's in the delay line, the input is faded out
+    std::atomic<bool> frozenState{ false };
 
-    float lastLowCut;
-    float lastHighCut;
+    // tap tempo -- averages the last few intervals, the timer moves the delay time knob
+    juce::int64 lastTap;
+    std::array<juce::int64, 3> tapIntervals;
+    int numTapIntervals;
+    std::atomic<float> tappedDelayTime{ -1.0f }; // ms, -1 when there's nothing new
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DelayAudioProcessor)
 };
@@ -0,0 +1,84 @@
+#include "RealFFT.h"
+#include "DSP.h"
+
+#include <cmath>
+#include <utility>
+
+RealFFT::RealFFT(int order) {
+    size = 1 << order;
+
+    twiddles.resize(size_t(size));
+    for (int k = 0; k < size / 2; ++k) {
+        double angle = -2.0 * PI * double(k) / double(size);
+        twiddles[size_t(2 * k)] = float(std::cos(angle));
+        twiddles[size_t(2 * k + 1)] = float(std::sin(angle));
+    }
+
+    reversed.resize(size_t(size));
+    for (int i = 0; i < size; ++i) {
+        int r = 0;
+        for (int bit = 1, mirrored = size >> 1; bit < size; bit <<= 1, mirrored >>= 1)
+            if (i & bit)
+                r |= mirrored;
+        reversed[size_t(i)] = r;
+    }
+}
+
+void RealFFT::perform(float* data, bool inverse) const noexcept {
+    for (int i = 0; i < size; ++i) {
+        int j = reversed[size_t(i)];
+        if (i < j) {
+            std::swap(data[2 * i], data[2 * j]);
+            std::swap(data[2 * i + 1], data[2 * j + 1]);
+        }
+    }
+
+    // the inverse is the same butterflies with conjugated twiddles
+    float sign = inverse ? -1.0f : 1.0f;
+
+    for (int half = 1; half < size; half <<= 1) {
+        int stride = size / (2 * half);
+
+        for (int start = 0; start < size; start += 2 * half) {
+            for (int k = 0; k < half; ++k) {
+                float wr = twiddles[size_t(2 * k * stride)];
+                float wi = twiddles[size_t(2 * k * stride + 1)] * sign;
+
+                float* a = data + 2 * (start + k);
+                float* b = data + 2 * (start + k + half);
+
+                float br = b[0] * wr - b[1] * wi;
+                float bi = b[0] * wi + b[1] * wr;
+
+                b[0] = a[0] - br;
+                b[1] = a[1] - bi;
+                a[0] += br;
+                a[1] += bi;
+            }
+        }
+    }
+}
+
+void RealFFT::performRealOnlyForwardTransform(float* data) const noexcept {
+    // spreads the samples out to complex values, from the back so nothing gets overwritten
+    for (int i = size - 1; i >= 0; --i) {
+        data[2 * i] = data[i];
+        data[2 * i + 1] = 0.0f;
+    }
+
+    perform(data, false);
+}
+
+void RealFFT::performRealOnlyInverseTransform(float* data) const noexcept {
+    // the negative frequencies are the complex conjugates of the positive ones
+    for (int i = size / 2 + 1; i < size; ++i) {
+        data[2 * i] = data[2 * (size - i)];
+        data[2 * i + 1] = -data[2 * (size - i) + 1];
+    }
+
+    perform(data, true);
+
+    float scale = 1.0f / float(size);
+    for (int i = 0; i < size; ++i)
+        data[i] = data[2 * i] * scale;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <vector>
+
+// Radix-2 FFT of a real signal, in place.
+//
+// Same data layout and scaling as juce::dsp::FFT's real-only transforms, so the
+// convolver doesn't need JUCE: data holds 2 * getSize() floats, the forward
+// transform takes getSize() samples and leaves the getSize() / 2 + 1 bins from
+// 0 Hz to nyquist as interleaved re/im, the inverse takes those bins and leaves
+// getSize() samples, scaled by 1 / getSize().
+class RealFFT
+{
+public:
+    // not on the audio thread -- builds the tables, the transforms don't allocate
+    explicit RealFFT(int order);
+
+    int getSize() const noexcept { return size; }
+
+    void performRealOnlyForwardTransform(float* data) const noexcept;
+    void performRealOnlyInverseTransform(float* data) const noexcept;
+
+private:
+    // complex FFT of `size` interleaved re/im values
+    void perform(float* data, bool inverse) const noexcept;
+
+    int size;
+    std::vector<float> twiddles; // e^(-2 pi i k / size) for k < size / 2, interleaved re/im
+    std::vector<int> reversed;   // bit-reversed index of every value
+};
@@ -0,0 +1,224 @@
+#include <JuceHeader.h>
+
+#include "RealtimeCheck.h"
+
+#if DELAY_REALTIME_CHECKS
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#if JUCE_LINUX
+    #include <dlfcn.h>
+    #include <pthread.h>
+
+    // glibc's own allocator entry points, so the wrappers below can forward to them
+    extern "C" void* __libc_malloc(size_t);
+    extern "C" void* __libc_calloc(size_t, size_t);
+    extern "C" void* __libc_realloc(void*, size_t);
+    extern "C" void* __libc_memalign(size_t, size_t);
+    extern "C" void __libc_free(void*);
+
+    // initial-exec TLS never allocates, the dynamic model could recurse into malloc
+    #define REALTIME_TLS_MODEL __attribute__((tls_model("initial-exec")))
+#else
+    #define REALTIME_TLS_MODEL
+#endif
+
+static thread_local int realtimeDepth REALTIME_TLS_MODEL = 0;
+static thread_local bool reporting REALTIME_TLS_MODEL = false; // the report itself allocates
+static std::atomic<int> numViolations{ 0 };
+
+static void reportViolation(const char* what) {
+    if (realtimeDepth == 0 || reporting)
+        return;
+
+    reporting = true;
+    numViolations.fetch_add(1);
+
+    auto trace = juce::SystemStats::getStackBacktrace();
+    std::fprintf(stderr, "!!! REALTIME VIOLATION: %s on the audio thread !!!\n%s\n", what, trace.toRawUTF8());
+    std::fflush(stderr);
+
+    // a jassert would be gone in release builds and a counter is easy to miss
+    std::abort();
+}
+
+ScopedRealtimeCheck::ScopedRealtimeCheck() noexcept {
+    ++realtimeDepth;
+    active = true;
+}
+
+ScopedRealtimeCheck::~ScopedRealtimeCheck() noexcept {
+    end();
+}
+
+void ScopedRealtimeCheck::end() noexcept {
+    if (active) {
+        --realtimeDepth;
+        active = false;
+    }
+}
+
+int getNumRealtimeViolations() noexcept {
+    return numViolations.load();
+}
+
+// ======= operator new/delete =======
+static void* allocate(std::size_t size) {
+    reportViolation("operator new");
+
+  #if JUCE_LINUX
+    void* p = __libc_malloc(size == 0 ? 1 : size);
+  #else
+    void* p = std::malloc(size == 0 ? 1 : size);
+  #endif
+
+    if (p == nullptr)
+        throw std::bad_alloc();
+
+    return p;
+}
+
+static void deallocate(void* p) noexcept {
+    if (p == nullptr)
+        return;
+
+    reportViolation("operator delete");
+
+  #if JUCE_LINUX
+    __libc_free(p);
+  #else
+    std::free(p);
+  #endif
+}
+
+static void* allocateAligned(std::size_t size, std::align_val_t alignment) {
+    reportViolation("aligned operator new");
+
+    auto align = std::max(std::size_t(alignment), sizeof(void*));
+    if (size == 0)
+        size = 1;
+
+  #if JUCE_LINUX
+    void* p = __libc_memalign(align, size);
+  #elif JUCE_WINDOWS
+    void* p = _aligned_malloc(size, align);
+  #else
+    void* p = nullptr;
+    if (posix_memalign(&p, align, size) != 0)
+        p = nullptr;
+  #endif
+
+    if (p == nullptr)
+        throw std::bad_alloc();
+
+    return p;
+}
+
+static void deallocateAligned(void* p) noexcept {
+    if (p == nullptr)
+        return;
+
+    reportViolation("aligned operator delete");
+
+  #if JUCE_LINUX
+    __libc_free(p);
+  #elif JUCE_WINDOWS
+    _aligned_free(p);
+  #else
+    std::free(p);
+  #endif
+}
+
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+void operator delete(void* p) noexcept { deallocate(p); }
+void operator delete[](void* p) noexcept { deallocate(p); }
+void operator delete(void* p, std::size_t) noexcept { deallocate(p); }
+void operator delete[](void* p, std::size_t) noexcept { deallocate(p); }
+
+void* operator new(std::size_t size, std::align_val_t alignment) { return allocateAligned(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return allocateAligned(size, alignment); }
+void operator delete(void* p, std::align_val_t) noexcept { deallocateAligned(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { deallocateAligned(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { deallocateAligned(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { deallocateAligned(p); }
+
+// ======= libc interposition, Linux only =======
+#if JUCE_LINUX
+extern "C" void* malloc(size_t size) {
+    reportViolation("malloc");
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size) {
+    reportViolation("calloc");
+    return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* p, size_t size) {
+    reportViolation("realloc");
+    return __libc_realloc(p, size);
+}
+
+extern "C" int posix_memalign(void** result, size_t alignment, size_t size) {
+    reportViolation("posix_memalign");
+
+    if (alignment < sizeof(void*) || (alignment & (alignment - 1)) != 0)
+        return EINVAL;
+
+    void* p = __libc_memalign(alignment, size);
+    if (p == nullptr)
+        return ENOMEM;
+
+    *result = p;
+    return 0;
+}
+
+extern "C" void* aligned_alloc(size_t alignment, size_t size) {
+    reportViolation("aligned_alloc");
+    return __libc_memalign(alignment, size);
+}
+
+extern "C" void free(void* p) {
+    if (p != nullptr)
+        reportViolation("free");
+    __libc_free(p);
+}
+
+// the next definition of a libc function, looked up on first use -- no function-static
+// guard for the cache, that could end up locking the mutex being wrapped
+template<typename Function>
+static Function nextSymbol(std::atomic<Function>& cache, const char* name) {
+    auto function = cache.load(std::memory_order_acquire);
+    if (function == nullptr) {
+        function = (Function) dlsym(RTLD_NEXT, name);
+        cache.store(function, std::memory_order_release);
+    }
+    return function;
+}
+
+using MutexFunction = int (*)(pthread_mutex_t*);
+static std::atomic<MutexFunction> realLock{ nullptr };
+static std::atomic<MutexFunction> realTryLock{ nullptr };
+
+// juce::CriticalSection and std::mutex both end up here
+extern "C" int pthread_mutex_lock(pthread_mutex_t* mutex) {
+    auto lock = nextSymbol(realLock, "pthread_mutex_lock");
+    reportViolation("pthread_mutex_lock");
+    return lock(mutex);
+}
+
+// tryEnter() / try_lock() -- doesn't block, but a lock on the audio thread is still a design error
+extern "C" int pthread_mutex_trylock(pthread_mutex_t* mutex) {
+    auto tryLock = nextSymbol(realTryLock, "pthread_mutex_trylock");
+    reportViolation("pthread_mutex_trylock");
+    return tryLock(mutex);
+}
+#endif
+
+#endif
@@ -0,0 +1,42 @@
+#pragma once
+
+// Catches allocations and locks on the audio thread in test builds.
+//
+// Build with DELAY_REALTIME_CHECKS=1 in the preprocessor definitions to enable.
+// While a ScopedRealtimeCheck is alive on a thread, operator new/delete including
+// the aligned forms (and on Linux the malloc family and pthread_mutex_lock/trylock)
+// print the violation with a stack trace and abort, in release builds too.
+// In regular builds it compiles to nothing. Tests/RealtimeStress/RealtimeStress.jucer drives it.
+
+#ifndef DELAY_REALTIME_CHECKS
+    #define DELAY_REALTIME_CHECKS 0
+#endif
+
+#if DELAY_REALTIME_CHECKS
+
+class ScopedRealtimeCheck
+{
+public:
+    ScopedRealtimeCheck() noexcept;
+    ~ScopedRealtimeCheck() noexcept;
+
+    void end() noexcept; // leaves the checked region early, e.g. before debug-only code
+
+private:
+    bool active;
+};
+
+// number of violations seen so far -- each one aborts, so anything above 0 means the abort was skipped
+int getNumRealtimeViolations() noexcept;
+
+#else
+
+class ScopedRealtimeCheck
+{
+public:
+    void end() noexcept { }
+};
+
+inline int getNumRealtimeViolations() noexcept { return 0; }
+
+#endif
@@ -24,13 +24,17 @@ RotaryKnob::RotaryKnob(const juce::String& text,
 
     setSize(70, 110);
 
-    setLookAndFeel(RotaryKnobLookAndFeel::get());
+    setLookAndFeel(&resources->rotaryKnobLookAndFeel);
 
     float pi = juce::MathConstants<float>::pi;
     slider.setRotaryParameters(1.25f * pi, 2.75f * pi, true);
     slider.getProperties().set("drawFromMiddle", drawFromMiddle);
 }
 
+RotaryKnob::~RotaryKnob() {
+    setLookAndFeel(nullptr);
+}
+
 void RotaryKnob::resized() {
     slider.setTopLeftPosition(0, 24);
 }
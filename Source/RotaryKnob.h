@@ -2,14 +2,19 @@
 
 #include <JuceHeader.h>
 
+#include "LookAndFeel.h"
+
 class RotaryKnob  : public juce::Component
 {
 public:
     RotaryKnob(const juce::String& text, juce::AudioProcessorValueTreeState& apvts, const juce::ParameterID& paramterID, bool drawFromMiddle = false);
-    ~RotaryKnob() override = default;
+    ~RotaryKnob() override;
 
     void resized() override;
 
+    // keeps the shared look and feel alive for as long as the knob exists -- declared first, destroyed last
+    juce::SharedResourcePointer<EditorResources> resources;
+
     juce::Slider slider;
     juce::Label label;
 
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+#include "FastMath.h"
+
+// All parameter smoothers in one structure-of-arrays block.
+//
+// Every lane is advanced by the same branch-free loop, linear lanes add a fixed
+// increment and exponential (one-pole) lanes move a fraction towards the target.
+// With 16 lanes that is two AVX registers per field. A single countdown tracks
+// the longest running ramp, so isSettled() is one compare.
+class SmootherBank
+{
+public:
+    static constexpr int numLanes = 16;
+
+    enum class Kind { linear, exponential };
+
+    SmootherBank() {
+        std::fill(current, current + numLanes, 0.0f);
+        std::fill(target, target + numLanes, 0.0f);
+        std::fill(increment, increment + numLanes, 0.0f);
+        std::fill(coeff, coeff + numLanes, 0.0f);
+        std::fill(remaining, remaining + numLanes, 0.0f);
+        std::fill(rampLength, rampLength + numLanes, 0.0f);
+        std::fill(isLinear, isLinear + numLanes, 1.0f);
+        settleCountdown = 0;
+    }
+
+    // linear -- reaches the target in exactly `seconds`
+    // exponential -- one-pole with time constant `seconds`, snaps to the target once within 1e-6 of the jump
+    void setup(int lane, Kind kind, double sampleRate, double seconds) noexcept {
+        if (kind == Kind::linear) {
+            isLinear[lane] = 1.0f;
+            coeff[lane] = 0.0f;
+            rampLength[lane] = std::floor(float(seconds * sampleRate));
+        }
+        else {
+            isLinear[lane] = 0.0f;
+            coeff[lane] = 1.0f - FastMath::exp(-1.0f / (float(seconds) * float(sampleRate)));
+            rampLength[lane] = std::ceil(std::log(1e-6f) / std::log(1.0f - coeff[lane]));
+        }
+        setCurrentAndTarget(lane, target[lane]);
+    }
+
+    void setCurrentAndTarget(int lane, float value) noexcept {
+        current[lane] = value;
+        target[lane] = value;
+        increment[lane] = 0.0f;
+        remaining[lane] = 0.0f;
+    }
+
+    // same rules as juce::LinearSmoothedValue::setTargetValue
+    void setTarget(int lane, float value) noexcept {
+        if (value == target[lane])
+            return;
+
+        target[lane] = value;
+
+        if (rampLength[lane] <= 0.0f) {
+            setCurrentAndTarget(lane, value);
+            return;
+        }
+
+        remaining[lane] = rampLength[lane];
+        increment[lane] = isLinear[lane] * (value - current[lane]) / rampLength[lane];
+        settleCountdown = std::max(settleCountdown, int(rampLength[lane]));
+    }
+
+    // one sample for every lane
+    void next() noexcept {
+        for (int i = 0; i < numLanes; ++i) {
+            float stepped = current[i] + increment[i] + (target[i] - current[i]) * coeff[i];
+            remaining[i] = std::max(remaining[i] - 1.0f, 0.0f);
+            current[i] = remaining[i] > 0.0f ? stepped : target[i];
+        }
+
+        settleCountdown -= settleCountdown > 0 ? 1 : 0;
+    }
+
+    float get(int lane) const noexcept { return current[lane]; }
+    float getTarget(int lane) const noexcept { return target[lane]; }
+
+    // every lane sits on its target, the values won't change until a new target is set
+    bool isSettled() const noexcept { return settleCountdown == 0; }
+
+private:
+    alignas(32) float current[numLanes];
+    alignas(32) float target[numLanes];
+    alignas(32) float increment[numLanes]; // linear lanes only
+    alignas(32) float coeff[numLanes];     // exponential lanes only
+    alignas(32) float remaining[numLanes]; // samples until the lane snaps to its target
+    float rampLength[numLanes];
+    float isLinear[numLanes];
+
+    int settleCountdown;
+};
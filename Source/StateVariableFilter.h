@@ -0,0 +1,74 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "FastMath.h"
+#include "DSP.h"
+
+// TPT state variable filter, the same topology and results as
+// juce::dsp::StateVariableTPTFilter at its default resonance (1 / sqrt(2)).
+// Filters a frame of any number of lanes that share the cutoff, the state of
+// each lane is kept apart so the loop over them vectorizes.
+//
+// The cutoffs glide per sample while they're smoothed, so the coefficient is
+// worked out with FastMath::tan instead of std::tan -- that's the only
+// transcendental left in the loop while a cutoff moves.
+class StateVariableFilter
+{
+public:
+    enum class Type { lowpass, highpass };
+
+    void setType(Type newType) noexcept { type = newType; }
+
+    // not on the audio thread -- allocates the state
+    void prepare(double sampleRate, int numLanes) {
+        piOverSampleRate = float(PI / sampleRate);
+        s1.resize(size_t(numLanes));
+        s2.resize(size_t(numLanes));
+        reset();
+    }
+
+    void reset() noexcept {
+        std::fill(s1.begin(), s1.end(), 0.0f);
+        std::fill(s2.begin(), s2.end(), 0.0f);
+    }
+
+    // below half the sample rate -- FastMath::tan holds its error bound up to 0.49 * fs
+    void setCutoffFrequency(float hz) noexcept {
+        g = FastMath::tan(piOverSampleRate * hz);
+        h = 1.0f / (1.0f + R2 * g + g * g);
+    }
+
+    // in place, one sample per lane
+    void process(float* frame) noexcept {
+        float* state1 = s1.data();
+        float* state2 = s2.data();
+        const int numLanes = int(s1.size());
+        const float gain = g, norm = h; // locals, the stores below could alias the members
+        const bool lowpass = type == Type::lowpass;
+
+        for (int lane = 0; lane < numLanes; ++lane) {
+            float x = frame[lane];
+            float yHP = norm * (x - state1[lane] * (gain + R2) - state2[lane]);
+
+            float yBP = yHP * gain + state1[lane];
+            state1[lane] = yHP * gain + yBP;
+
+            float yLP = yBP * gain + state2[lane];
+            state2[lane] = yBP * gain + yLP;
+
+            frame[lane] = lowpass ? yLP : yHP;
+        }
+    }
+
+private:
+    static constexpr float R2 = 1.41421356237f; // 1 / resonance
+
+    Type type = Type::lowpass;
+    float piOverSampleRate = float(PI / 44100.0);
+    float g = 0.0f;
+    float h = 1.0f;
+    std::vector<float> s1; // per lane
+    std::vector<float> s2;
+};
@@ -3,49 +3,239 @@
 #include "Utilities.h"
 #include "Parameters.h"
 
+// ======= ValueText =======
+void ValueText::append(char c) noexcept {
+    if (length < capacity - 1) { // keeps room for the terminating zero
+        data[length++] = c;
+        data[length] = '\0';
+    }
+}
+
+void ValueText::append(const char* text) noexcept {
+    while (*text != '\0')
+        append(*text++);
+}
+
+void ValueText::appendInteger(int value) noexcept {
+    if (value < 0)
+        append('-');
+
+    // digits come out in reverse order
+    char digits[12];
+    int numDigits = 0;
+    unsigned int n = value < 0 ? 0u - unsigned(value) : unsigned(value);
+
+    do {
+        digits[numDigits++] = char('0' + n % 10);
+        n /= 10;
+    } while (n != 0);
+
+    while (numDigits > 0)
+        append(digits[--numDigits]);
+}
+
+void ValueText::appendNumber(float value, int decimals) noexcept {
+    static constexpr long long powersOfTen[] = { 1, 10, 100, 1000, 10000 };
+    decimals = juce::jlimit(0, 4, decimals);
+
+    if (!std::isfinite(value)) {
+        append('0');
+        return;
+    }
+
+    // rounds once on the scaled value so "9.995" becomes "10.00" and not "9.100"
+    long long scale = powersOfTen[decimals];
+    long long scaled = (long long)(std::abs(double(value)) * double(scale) + 0.5);
+
+    if (value < 0.0f && scaled != 0)
+        append('-');
+
+    long long whole = scaled / scale;
+    long long fraction = scaled % scale;
+
+    char digits[20];
+    int numDigits = 0;
+    do {
+        digits[numDigits++] = char('0' + whole % 10);
+        whole /= 10;
+    } while (whole != 0);
+
+    while (numDigits > 0)
+        append(digits[--numDigits]);
+
+    if (decimals > 0) {
+        append('.');
+        for (long long divisor = scale / 10; divisor > 0; divisor /= 10)
+            append(char('0' + (fraction / divisor) % 10));
+    }
+}
+
+// ======= formatters =======
+void formatMilliseconds(float value, ValueText& text) {
+    if (value < 10.0f) {
+        text.appendNumber(value, 2);
+        text.append(" ms");
+    }
+    else if (value < 100.0f) {
+        text.appendNumber(value, 1);
+        text.append(" ms");
+    }
+    else if (value < 1000.0f) {
+        text.appendInteger(int(value));
+        text.append(" ms");
+    }
+    else {
+        text.appendNumber(value * 0.001f, 2);
+        text.append(" s");
+    }
+}
+
+void formatDecibels(float value, ValueText& text) {
+    text.appendNumber(value, 1);
+    text.append(" dB");
+}
+
+void formatPercent(float value, ValueText& text) {
+    text.appendInteger(int(value));
+    text.append(" %");
+}
+
+void formatHz(float value, ValueText& text) {
+    if (value < 1000.0f) {
+        text.appendInteger(int(value));
+        text.append(" Hz");
+    }
+    else if (value < 10000.0f) {
+        text.appendNumber(value / 1000.0f, 2);
+        text.append(" k");
+    }
+    else {
+        text.appendNumber(value / 1000.0f, 1);
+        text.append(" k");
+    }
+}
+
+void formatSemitones(float value, ValueText& text) {
+    int semitones = juce::roundToInt(value);
+    if (semitones > 0)
+        text.append('+');
+    text.appendInteger(semitones);
+    text.append(" st");
+}
+
+// ======= parsing =======
+float parseLeadingFloat(const char* text) noexcept {
+    while (*text == ' ' || *text == '\t')
+        ++text;
+
+    bool negative = false;
+    if (*text == '-' || *text == '+')
+        negative = *text++ == '-';
+
+    double value = 0.0;
+    while (*text >= '0' && *text <= '9')
+        value = value * 10.0 + double(*text++ - '0');
+
+    if (*text == '.') {
+        ++text;
+        double scale = 0.1;
+        while (*text >= '0' && *text <= '9') {
+            value += double(*text++ - '0') * scale;
+            scale *= 0.1;
+        }
+    }
+
+    return float(negative ? -value : value);
+}
+
+// same as juce::String::endsWithIgnoreCase but on the raw characters
+static bool endsWithIgnoreCase(const char* text, const char* suffix) noexcept {
+    size_t textLength = std::strlen(text);
+    size_t suffixLength = std::strlen(suffix);
+
+    if (suffixLength > textLength)
+        return false;
+
+    const char* end = text + textLength - suffixLength;
+    for (size_t i = 0; i < suffixLength; ++i)
+        if (std::tolower((unsigned char) end[i]) != std::tolower((unsigned char) suffix[i]))
+            return false;
+
+    return true;
+}
+
+// ======= ValueTextCache =======
+ValueTextCache::ValueTextCache(ValueFormatter f) {
+    formatter = f;
+    values.fill(0.0f);
+}
+
+juce::String ValueTextCache::get(float value) {
+    {
+        const juce::SpinLock::ScopedLockType sl(lock);
+        for (int i = 0; i < numUsed; ++i)
+            if (values[size_t(i)] == value)
+                return texts[size_t(i)]; // shares the cached string
+    }
+
+    // only a cache miss pays for the one juce::String the host asked for
+    ValueText text;
+    formatter(value, text);
+    juce::String result(text.data, size_t(text.length));
+
+    const juce::SpinLock::ScopedLockType sl(lock);
+    values[size_t(nextEntry)] = value;
+    texts[size_t(nextEntry)] = result;
+    nextEntry = (nextEntry + 1) % numEntries;
+    numUsed = juce::jmin(numUsed + 1, numEntries);
+
+    return result;
+}
+
+std::function<juce::String(float, int)> makeCachedFormatter(ValueFormatter formatter) {
+    auto cache = std::make_shared<ValueTextCache>(formatter);
+    return [cache](float value, int) { return cache->get(value); };
+}
+
+// ======= juce::String wrappers =======
+static juce::String stringFromFormatter(ValueFormatter formatter, float value) {
+    ValueText text;
+    formatter(value, text);
+    return juce::String(text.data, size_t(text.length));
+}
+
 juce::String stringFromMilliseconds(float value, int) {
-    if (value < 10.0f)
-        return juce::String(value, 2) + " ms";
-    else if (value < 100.0f)
-        return juce::String(value, 1) + " ms";
-    else if (value < 1000.0f)
-        return juce::String(int(value)) + " ms";
-    else
-        return juce::String(value * 0.001f, 2) + " s";
+    return stringFromFormatter(formatMilliseconds, value);
 }
 
 float millisecondsFromString(const juce::String& text) {
-    float value = text.getFloatValue();
+    const char* raw = text.toRawUTF8(); // points at the string's own storage, no copy
+    float value = parseLeadingFloat(raw);
 
-    if (!text.endsWithIgnoreCase("ms"))
-        if (text.endsWithIgnoreCase("s") || value < Parameters::minDelayTime)
+    if (!endsWithIgnoreCase(raw, "ms"))
+        if (endsWithIgnoreCase(raw, "s") || value < Parameters::minDelayTime)
             return value * 1000.0f;
 
     return value;
 }
 
 juce::String stringFromDecibels(float value, int) {
-    return juce::String(value, 1) + " dB";
+    return stringFromFormatter(formatDecibels, value);
 }
 
 juce::String stringFromPercent(float value, int){
-    return juce::String(int(value)) + " %";
+    return stringFromFormatter(formatPercent, value);
 }
 
 juce::String stringFromHz(float value, int) {
-    if (value < 1000.0f)
-        return juce::String(int(value)) + " Hz";
-    else if (value < 10000.0f)
-        return juce::String(value / 1000.0f, 2) + " k";
-    else
-        return juce::String(value / 1000.0f, 1) + " k";
+    return stringFromFormatter(formatHz, value);
 }
 
 float hzFromString(const juce::String& str) {
-    float value = str.getFloatValue();
+    float value = parseLeadingFloat(str.toRawUTF8());
 
-    if (value < 20.0f) 
+    if (value < 20.0f)
         return value * 1000.0f;
 
     return value;
-}
\ No newline at end of file
+}
@@ -1,5 +1,63 @@
 #pragma once
 
+#include <JuceHeader.h>
+
+#include <array>
+#include <functional>
+
+// ======= allocation-free value text =======
+// fixed stack buffer that the formatters write into, so hosts calling getText()
+// don't build a chain of juce::String temporaries for every value
+struct ValueText
+{
+    static constexpr int capacity = 24;
+
+    char data[capacity] = {};
+    int length = 0;
+
+    void append(char c) noexcept;
+    void append(const char* text) noexcept;
+    void appendInteger(int value) noexcept;
+    void appendNumber(float value, int decimals) noexcept; // fixed number of decimals, rounded
+};
+
+using ValueFormatter = void (*)(float value, ValueText& text);
+
+// UI converting functions -- write into a stack buffer, no heap allocations
+void formatMilliseconds(float value, ValueText& text);
+void formatDecibels(float value, ValueText& text);
+void formatPercent(float value, ValueText& text);
+void formatHz(float value, ValueText& text);
+void formatSemitones(float value, ValueText& text);
+
+// parses a leading number like "12.5 ms" -- stops at the first character that isn't part of it
+float parseLeadingFloat(const char* text) noexcept;
+
+// ======= per-parameter text cache =======
+// remembers the last few formatted values of one parameter, copies of a cached
+// juce::String only bump a reference count
+class ValueTextCache
+{
+public:
+    explicit ValueTextCache(ValueFormatter formatter);
+
+    juce::String get(float value);
+
+private:
+    static constexpr int numEntries = 8;
+
+    ValueFormatter formatter;
+    juce::SpinLock lock; // getText() can be called from several host threads
+
+    std::array<float, numEntries> values;
+    std::array<juce::String, numEntries> texts;
+    int numUsed = 0;
+    int nextEntry = 0; // round robin replacement
+};
+
+// creates a stringFromValueFunction with its own cache for the parameter layout
+std::function<juce::String(float, int)> makeCachedFormatter(ValueFormatter formatter);
+
 // UI converting functions
 juce::String stringFromMilliseconds(float value, int);
 juce::String stringFromDecibels(float value, int);
@@ -7,4 +65,4 @@ juce::String stringFromPercent(float value, int);
 float millisecondsFromString(const juce::String& text);
 
 juce::String stringFromHz(float value, int);
-float hzFromString(const juce::String& str);
\ No newline at end of file
+float hzFromString(const juce::String& str);
@@ -0,0 +1,205 @@
+#include <JuceHeader.h>
+
+#include <cstdio>
+#include <vector>
+
+#include "../../../Source/PluginProcessor.h"
+#include "../../../Source/RealtimeCheck.h"
+
+// Randomized realtime-safety driver for DelayAudioProcessor.
+//
+// Built with DELAY_REALTIME_CHECKS=1, so anything in processBlock that allocates
+// or locks aborts with a stack trace. While it runs:
+//   - the audio thread calls processBlock like a host does -- under the callback
+//     lock, with random block sizes and random automation in between blocks
+//   - the state thread loads saved states with setStateInformation
+//   - the main thread is the message thread: it runs the processor's timer, sends
+//     the editor's commands and cycles releaseResources / prepareToPlay at random
+//     sample rates and block sizes
+//
+// usage: RealtimeStress [--seconds=60] [--seed=n]
+
+static constexpr double sampleRates[] = { 44100.0, 48000.0, 88200.0, 96000.0 };
+static constexpr int blockSizes[] = { 16, 32, 64, 100, 128, 256, 512, 1024, 4096 };
+static constexpr int maxBlockSize = 4096;
+
+template<typename T, size_t size>
+static T pick(juce::Random& random, const T (&values)[size]) {
+    return values[random.nextInt(int(size))];
+}
+
+// ======= audio thread =======
+class AudioThread : public juce::Thread
+{
+public:
+    AudioThread(DelayAudioProcessor& p, juce::int64 seed)
+        : juce::Thread("Audio"), processor(p), random(seed), buffer(2, maxBlockSize)
+    { }
+
+    // largest block the processor was prepared for, 0 while it isn't prepared
+    std::atomic<int> blockSize{ 0 };
+    std::atomic<juce::int64> numBlocks{ 0 };
+
+    void run() override {
+        juce::MidiBuffer midi;
+
+        while (!threadShouldExit()) {
+            {
+                const juce::ScopedLock lock(processor.getCallbackLock());
+
+                int maxSamples = blockSize.load();
+                if (maxSamples > 0 && !processor.isSuspended()) {
+                    automate();
+
+                    // hosts may send less than they announced, down to a single sample
+                    int numSamples = 1 + random.nextInt(maxSamples);
+                    juce::AudioBuffer<float> block(buffer.getArrayOfWritePointers(), 2, numSamples);
+                    fillInput(block);
+
+                    processor.processBlock(block, midi);
+                    ++numBlocks;
+                }
+            }
+
+            juce::Thread::yield();
+        }
+    }
+
+private:
+    // a few parameter changes per block, passed in before processBlock the way
+    // plug-in wrappers do -- outside the checked region, like in a real host
+    void automate() {
+        auto& parameters = processor.getParameters();
+
+        for (int i = random.nextInt(4); i > 0; --i) {
+            auto* parameter = parameters[random.nextInt(parameters.size())];
+            float value = random.nextFloat();
+            parameter->setValue(value);
+            parameter->sendValueChangedMessageToListeners(value);
+        }
+    }
+
+    // noise most of the time, now and then silence so the loop has to ring out
+    void fillInput(juce::AudioBuffer<float>& block) {
+        bool silent = random.nextInt(8) == 0;
+
+        for (int ch = 0; ch < block.getNumChannels(); ++ch) {
+            float* data = block.getWritePointer(ch);
+            for (int i = 0; i < block.getNumSamples(); ++i)
+                data[i] = silent ? 0.0f : (random.nextFloat() * 2.0f - 1.0f) * 0.25f;
+        }
+    }
+
+    DelayAudioProcessor& processor;
+    juce::Random random;
+    juce::AudioBuffer<float> buffer;
+};
+
+// ======= state thread =======
+class StateThread : public juce::Thread
+{
+public:
+    StateThread(DelayAudioProcessor& p, const std::vector<juce::MemoryBlock>& s, juce::int64 seed)
+        : juce::Thread("State"), processor(p), states(s), random(seed)
+    { }
+
+    std::atomic<int> numLoads{ 0 };
+
+    void run() override {
+        while (!threadShouldExit()) {
+            const auto& state = states[size_t(random.nextInt(int(states.size())))];
+            processor.setStateInformation(state.getData(), int(state.getSize()));
+            ++numLoads;
+
+            wait(5 + random.nextInt(45));
+        }
+    }
+
+private:
+    DelayAudioProcessor& processor;
+    const std::vector<juce::MemoryBlock>& states;
+    juce::Random random;
+};
+
+// ======= message thread =======
+int main(int argc, char* argv[]) {
+    juce::ScopedJuceInitialiser_GUI juceInitialiser; // this thread becomes the message thread
+    juce::ArgumentList args(argc, argv);
+
+    double seconds = args.containsOption("--seconds") ? args.getValueForOption("--seconds").getDoubleValue() : 60.0;
+    juce::int64 seed = args.containsOption("--seed") ? args.getValueForOption("--seed").getLargeIntValue()
+                                                     : juce::Time::currentTimeMillis();
+    std::printf("RealtimeStress -- seed %lld, %.0f seconds\n", (long long) seed, seconds);
+
+    juce::Random random(seed);
+    DelayAudioProcessor processor;
+
+    // saved states with random settings for the state thread
+    std::vector<juce::MemoryBlock> states(8);
+    for (auto& state : states) {
+        for (auto* parameter : processor.getParameters())
+            parameter->setValueNotifyingHost(random.nextFloat());
+        processor.getStateInformation(state);
+    }
+
+    AudioThread audioThread(processor, seed + 1);
+    StateThread stateThread(processor, states, seed + 2);
+    int numPrepares = 0;
+    int numCommands = 0;
+
+    auto prepare = [&] {
+        double sampleRate = pick(random, sampleRates);
+        int samplesPerBlock = pick(random, blockSizes);
+
+        processor.setRateAndBufferSizeDetails(sampleRate, samplesPerBlock);
+        processor.prepareToPlay(sampleRate, samplesPerBlock);
+        audioThread.blockSize.store(samplesPerBlock);
+        ++numPrepares;
+    };
+
+    auto release = [&] {
+        audioThread.blockSize.store(0);
+        const juce::ScopedLock lock(processor.getCallbackLock()); // waits for the block in flight
+        processor.releaseResources();
+    };
+
+    prepare();
+    audioThread.startThread(juce::Thread::Priority::highest);
+    stateThread.startThread();
+
+    double end = juce::Time::getMillisecondCounterHiRes() + seconds * 1000.0;
+    while (juce::Time::getMillisecondCounterHiRes() < end) {
+        // the processor's timer -- long mode, the internal rate, the convolution kernels
+        juce::MessageManager::getInstance()->runDispatchLoopUntil(20 + random.nextInt(80));
+
+        // the editor's buttons
+        if (random.nextInt(4) == 0) {
+            processor.sendCommand(DelayCommand::Type(random.nextInt(4)));
+            ++numCommands;
+        }
+
+        // the host stopping and starting again, usually at another rate or block size
+        if (random.nextInt(20) == 0) {
+            release();
+            prepare();
+        }
+    }
+
+    stateThread.stopThread(2000);
+    audioThread.stopThread(2000);
+    release();
+
+    std::printf("%lld blocks, %d prepares, %d state loads, %d commands\n",
+                (long long) audioThread.numBlocks.load(), numPrepares, stateThread.numLoads.load(), numCommands);
+
+    // every violation aborts on the spot, the counter is a second line of defence
+    int violations = getNumRealtimeViolations();
+    jassert(violations == 0);
+    if (violations != 0) {
+        std::printf("FAILED -- %d realtime violations\n", violations);
+        return 1;
+    }
+
+    std::printf("passed\n");
+    return 0;
+}